@@ -0,0 +1,141 @@
+/* Filename: AsyncLookup.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements GetTask, the coroutine type behind
+ * HashTable::asyncGet(). Each task is one lookup that suspends after issuing
+ * a prefetch. runInterleaved() resumes a group of tasks round-robin, so their
+ * cache misses overlap instead of being paid one after another. Coroutine
+ * frames are recycled per thread, keeping the allocator off the lookup path.
+ */
+
+#include <exception>
+#include <new>
+#include <utility>
+#include "AsyncLookup.h"
+
+namespace {
+
+// freed coroutine frames of one size, reused by the next lookups on this thread
+struct FrameCache {
+    static constexpr size_t MAX_FRAMES = 64;
+
+    size_t frameSize = 0;
+    std::vector<void*> frames;
+
+    ~FrameCache() {
+        for (void* frame : frames) ::operator delete(frame);
+    }
+};
+
+thread_local FrameCache frameCache;
+
+} // namespace
+
+/* Purpose: Wraps a new coroutine's handle in its GetTask.
+ */
+GetTask GetTask::promise_type::get_return_object() {
+    return GetTask(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+/* Purpose: Stores the lookup's result when the coroutine co_returns.
+ */
+void GetTask::promise_type::return_value(const std::optional<int> value) {
+    result = value;
+}
+
+/* Purpose: Lets an exception from the lookup propagate out of resume().
+ */
+void GetTask::promise_type::unhandled_exception() {
+    throw;
+}
+
+/* Purpose: Allocates a coroutine frame, reusing a cached one if it fits.
+ * Parameters:
+ *    size – frame size the compiler asks for
+ */
+void* GetTask::promise_type::operator new(const size_t size) {
+    if (size == frameCache.frameSize && !frameCache.frames.empty()) {
+        void* frame = frameCache.frames.back();
+        frameCache.frames.pop_back();
+        return frame;
+    }
+    return ::operator new(size);
+}
+
+/* Purpose: Returns a coroutine frame to this thread's cache, or frees it.
+ * Parameters:
+ *    frame – frame to release
+ *    size – its size
+ * Behavior:
+ *    The cache holds frames of a single size; frames of another size, or
+ *    beyond MAX_FRAMES, go back to the global allocator.
+ */
+void GetTask::promise_type::operator delete(void* frame, const size_t size) {
+    if (frameCache.frames.empty()) frameCache.frameSize = size;
+    if (size == frameCache.frameSize && frameCache.frames.size() < FrameCache::MAX_FRAMES) {
+        frameCache.frames.push_back(frame);
+        return;
+    }
+    ::operator delete(frame);
+}
+
+/* Purpose: Takes ownership of a coroutine handle.
+ */
+GetTask::GetTask(const std::coroutine_handle<promise_type> handle) : handle(handle) {
+}
+
+/* Purpose: Moves a task, leaving the source empty.
+ */
+GetTask::GetTask(GetTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {
+}
+
+/* Purpose: Replaces this task with another, destroying the old coroutine.
+ */
+GetTask& GetTask::operator=(GetTask&& other) noexcept {
+    if (this != &other) {
+        if (handle) handle.destroy();
+        handle = std::exchange(other.handle, nullptr);
+    }
+    return *this;
+}
+
+/* Purpose: Destroys the coroutine, finished or not.
+ */
+GetTask::~GetTask() {
+    if (handle) handle.destroy();
+}
+
+/* Purpose: Checks whether the task holds a coroutine.
+ */
+GetTask::operator bool() const {
+    return static_cast<bool>(handle);
+}
+
+/* Purpose: Checks whether the lookup has finished.
+ */
+bool GetTask::done() const {
+    return handle.done();
+}
+
+/* Purpose: Runs the lookup until it next waits on memory or finishes.
+ */
+void GetTask::resume() {
+    handle.resume();
+}
+
+/* Purpose: Returns the lookup's result.
+ * Returns:
+ *    optional<int> – the value, or nullopt if the key is missing; only
+ *    meaningful once done()
+ */
+std::optional<int> GetTask::result() const {
+    return handle.promise().result;
+}
+
+/* Purpose: Runs the lookup to completion on its own, without interleaving.
+ * Returns:
+ *    optional<int> – as result()
+ */
+std::optional<int> GetTask::run() {
+    while (!done()) resume();
+    return result();
+}
@@ -0,0 +1,89 @@
+/*
+ * AsyncLookup.h
+ */
+#pragma once
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// a lazily started lookup that suspends whenever it waits on memory
+class GetTask {
+    public:
+        struct promise_type {
+            std::optional<int> result;
+
+            GetTask get_return_object();
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_value(std::optional<int> value);
+            void unhandled_exception();
+
+            static void* operator new(size_t size);
+            static void operator delete(void* frame, size_t size);
+        };
+
+        GetTask() = default;
+        GetTask(const GetTask& other) = delete;
+        GetTask(GetTask&& other) noexcept;
+        GetTask& operator=(const GetTask& other) = delete;
+        GetTask& operator=(GetTask&& other) noexcept;
+        ~GetTask();
+
+        explicit operator bool() const;
+
+        [[nodiscard]] bool done() const;
+
+        void resume();
+
+        [[nodiscard]] std::optional<int> result() const;
+
+        std::optional<int> run();
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+
+        explicit GetTask(std::coroutine_handle<promise_type> handle);
+};
+
+/* Purpose: Runs count lookups with up to groupSize of them in flight.
+ * Parameters:
+ *    count – number of lookups
+ *    groupSize – lookups interleaved at once
+ *    makeTask – makeTask(i) starts lookup i and returns its GetTask
+ *    onDone – onDone(i, result) receives each result
+ * Behavior:
+ *    Resumes the in-flight lookups round-robin. Each one issues a prefetch
+ *    and suspends, so by the time its turn comes again the memory it
+ *    waited on has usually arrived. A finished lookup's slot is refilled
+ *    with the next one at once. Results arrive out of order.
+ */
+template <typename MakeTask, typename OnDone>
+void runInterleaved(const size_t count, size_t groupSize, MakeTask&& makeTask, OnDone&& onDone) {
+    groupSize = std::clamp<size_t>(groupSize, 1, std::max<size_t>(count, 1));
+    std::vector<GetTask> ring;
+    std::vector<size_t> lookupOf;
+    size_t next = 0;
+    for (; next < std::min(groupSize, count); next++) {
+        ring.push_back(makeTask(next));
+        lookupOf.push_back(next);
+    }
+
+    for (size_t active = ring.size(); active > 0;) {
+        for (size_t slot = 0; slot < ring.size(); slot++) {
+            if (!ring[slot]) continue;
+            ring[slot].resume();
+            if (!ring[slot].done()) continue;
+
+            onDone(lookupOf[slot], ring[slot].result());
+            if (next < count) {
+                ring[slot] = makeTask(next);
+                lookupOf[slot] = next++;
+            } else {
+                ring[slot] = GetTask();
+                active--;
+            }
+        }
+    }
+}
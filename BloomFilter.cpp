@@ -0,0 +1,106 @@
+/* Filename: BloomFilter.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements BloomFilter, a blocked Bloom filter
+ * used in front of HashTable to answer most negative lookups without probing.
+ * A key's bits all lie in one 64-byte block picked by its hash, so adding or
+ * testing a key touches a single cache line. The filter works on precomputed
+ * 64-bit hashes and may report false positives but never false negatives.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "BloomFilter.h"
+
+/* Purpose: Constructs a filter sized for an expected number of keys.
+ * Parameters:
+ *    expectedKeys – keys the filter should hold at its target error rate
+ *    bitsPerKey – filter bits per expected key (10 gives about 1% false positives)
+ *    alloc – allocator for the bit array
+ * Behavior:
+ *    Picks the number of bits set per key that minimizes false positives
+ *    for the given density, capped at 7 so they fit in one 64-bit hash.
+ */
+BloomFilter::BloomFilter(const size_t expectedKeys, const size_t bitsPerKey, const allocator_type& alloc)
+    : m_blocks(std::max<size_t>(1, (expectedKeys * bitsPerKey + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK)),
+      m_bitsPerBlockKey(std::clamp<size_t>(static_cast<size_t>(std::lround(0.69 * bitsPerKey)), 1, 7)),
+      m_count(0), words(m_blocks * WORDS_PER_BLOCK, 0, alloc) {
+}
+
+/* Purpose: Picks the block that holds a key's bits.
+ * Parameters:
+ *    h – 64-bit hash of the key
+ * Returns:
+ *    size_t – block index, from the high half of the hash
+ */
+size_t BloomFilter::blockFor(const uint64_t h) const {
+    return static_cast<size_t>(((h >> 32) * m_blocks) >> 32);
+}
+
+/* Purpose: Adds a key to the filter.
+ * Parameters:
+ *    h – 64-bit hash of the key
+ * Behavior:
+ *    Sets m_bitsPerBlockKey bits of one block, each chosen by 9 bits of the
+ *    re-mixed hash.
+ */
+void BloomFilter::add(const uint64_t h) {
+    uint64_t* block = &words[blockFor(h) * WORDS_PER_BLOCK];
+    const uint64_t bits = h * 0x9e3779b97f4a7c15ULL;
+
+    for (size_t i = 0; i < m_bitsPerBlockKey; i++) {
+        const size_t bit = (bits >> (i * 9)) & (BITS_PER_BLOCK - 1);
+        block[bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+    m_count++;
+}
+
+/* Purpose: Tests whether a key may have been added.
+ * Parameters:
+ *    h – 64-bit hash of the key
+ * Returns:
+ *    false if the key was definitely never added, true if it may have been
+ */
+bool BloomFilter::mayContain(const uint64_t h) const {
+    const uint64_t* block = &words[blockFor(h) * WORDS_PER_BLOCK];
+    const uint64_t bits = h * 0x9e3779b97f4a7c15ULL;
+
+    for (size_t i = 0; i < m_bitsPerBlockKey; i++) {
+        const size_t bit = (bits >> (i * 9)) & (BITS_PER_BLOCK - 1);
+        if ((block[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) return false;
+    }
+    return true;
+}
+
+/* Purpose: Removes every key from the filter, keeping its size.
+ */
+void BloomFilter::clear() {
+    std::fill(words.begin(), words.end(), 0);
+    m_count = 0;
+}
+
+/* Purpose: Returns how many keys were added since the last clear().
+ * Returns:
+ *    size_t – number of add() calls, including keys since removed from the table
+ */
+size_t BloomFilter::count() const {
+    return m_count;
+}
+
+/* Purpose: Returns the size of the bit array.
+ * Returns:
+ *    size_t – bytes used by the filter's blocks
+ */
+size_t BloomFilter::bytes() const {
+    return words.size() * sizeof(uint64_t);
+}
+
+/* Purpose: Estimates the current false-positive rate.
+ * Returns:
+ *    double – standard Bloom estimate (1 - e^(-kn/m))^k for the keys added;
+ *    blocking raises the real rate slightly above this
+ */
+double BloomFilter::expectedFalsePositiveRate() const {
+    const double k = static_cast<double>(m_bitsPerBlockKey);
+    const double fill = 1.0 - std::exp(-k * static_cast<double>(m_count) / static_cast<double>(words.size() * 64));
+    return std::pow(fill, k);
+}
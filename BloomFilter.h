@@ -0,0 +1,37 @@
+/*
+ * BloomFilter.h
+ */
+#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+class BloomFilter {
+    private:
+        static constexpr size_t WORDS_PER_BLOCK = 8; // one 64-byte cache line per block
+        static constexpr size_t BITS_PER_BLOCK = WORDS_PER_BLOCK * 64;
+
+        size_t m_blocks; // number of blocks
+        size_t m_bitsPerBlockKey; // bits set per key, all inside one block
+        size_t m_count; // keys added since the last clear()
+        std::pmr::vector<uint64_t> words; // m_blocks * WORDS_PER_BLOCK words
+
+        [[nodiscard]] size_t blockFor(uint64_t h) const;
+
+    public:
+        using allocator_type = std::pmr::polymorphic_allocator<uint64_t>;
+
+        explicit BloomFilter(size_t expectedKeys = 0, size_t bitsPerKey = 10, const allocator_type& alloc = {});
+
+        void add(uint64_t h);
+
+        [[nodiscard]] bool mayContain(uint64_t h) const;
+
+        void clear();
+
+        [[nodiscard]] size_t count() const;
+
+        [[nodiscard]] size_t bytes() const;
+
+        [[nodiscard]] double expectedFalsePositiveRate() const;
+};
@@ -0,0 +1,248 @@
+/* Filename: ConcurrentCounterTable.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements ConcurrentCounterTable, a hash table
+ * specialized for counting that many threads can update at once without a lock.
+ * Counts are std::atomic<int64_t>, so incrementing a key that already exists is a
+ * probe plus one fetch_add. A new key claims an empty slot with a compare-and-swap
+ * and publishes its key before any other thread can match it. The table is sized
+ * up front and never resizes, which is what keeps existing slots lock-free.
+ * LocalBuffer combines a thread's increments in a private HashTable and flushes
+ * them in batches, so hot keys cost one atomic add per flush.
+ */
+
+#include "ConcurrentCounterTable.h"
+#include "HashFunctions.h"
+#include <stdexcept>
+#include <thread>
+
+/* Purpose: Constructs a counter table sized for an expected number of keys.
+ * Parameters:
+ *    expectedKeys – how many distinct keys the table must hold
+ * Behavior:
+ *    Rounds the slot count up to a power of two that keeps the load factor at
+ *    or below MAX_LOAD_FACTOR when expectedKeys are stored.
+ */
+ConcurrentCounterTable::ConcurrentCounterTable(const size_t expectedKeys) : m_capacity(8) {
+    while (static_cast<double>(expectedKeys) > MAX_LOAD_FACTOR * static_cast<double>(m_capacity)) {
+        m_capacity *= 2;
+    }
+    slots = std::make_unique<Slot[]>(m_capacity);
+}
+
+/* Purpose: Computes the full hash of a key.
+ * Parameters:
+ *    key – string key to hash
+ * Returns:
+ *    uint64_t – full hash; low bits pick the slot, high bits form the tag
+ */
+uint64_t ConcurrentCounterTable::hash(const std::string_view key) {
+    return mix64(fnv1a64(key));
+}
+
+/* Purpose: Finds the READY slot holding a key.
+ * Parameters:
+ *    key – string key to search
+ *    h – hash of key
+ * Returns:
+ *    pointer to the slot, or nullptr if the key is not in the table
+ * Behavior:
+ *    Linear probing. A slot another thread is still writing is waited on,
+ *    since it may be about to publish this very key.
+ */
+const ConcurrentCounterTable::Slot* ConcurrentCounterTable::find(const std::string_view key, const uint64_t h) const {
+    const uint32_t tag = static_cast<uint32_t>(h >> 32);
+
+    for (size_t i = 0, index = h & (m_capacity - 1); i < m_capacity; i++, index = (index + 1) & (m_capacity - 1)) {
+        const Slot& slot = slots[index];
+        uint8_t state = slot.state.load(std::memory_order_acquire);
+
+        while (state == WRITING) {
+            std::this_thread::yield();
+            state = slot.state.load(std::memory_order_acquire);
+        }
+        if (state == EMPTY) {
+            return nullptr;
+        }
+        if (slot.tag == tag && slot.key == key) {
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+/* Purpose: Finds a key's slot, claiming an empty one if the key is new.
+ * Parameters:
+ *    key – string key to find or insert
+ *    h – hash of key
+ * Returns:
+ *    reference to the key's slot
+ * Throws:
+ *    length_error if the table has no room for another key
+ * Behavior:
+ *    An empty slot is claimed with a compare-and-swap; the winner writes the
+ *    tag and key, then publishes the slot as READY. A thread that loses the
+ *    race re-examines the same slot, because the winner may have inserted the
+ *    same key.
+ */
+ConcurrentCounterTable::Slot& ConcurrentCounterTable::findOrClaim(const std::string_view key, const uint64_t h) {
+    const uint32_t tag = static_cast<uint32_t>(h >> 32);
+    size_t index = h & (m_capacity - 1);
+
+    for (size_t i = 0; i < m_capacity;) {
+        Slot& slot = slots[index];
+        uint8_t state = slot.state.load(std::memory_order_acquire);
+
+        if (state == EMPTY) {
+            if (static_cast<double>(m_size.load(std::memory_order_relaxed)) >= MAX_LOAD_FACTOR * m_capacity) {
+                throw std::length_error("ConcurrentCounterTable is full");
+            }
+            if (slot.state.compare_exchange_strong(state, WRITING, std::memory_order_acquire)) {
+                slot.tag = tag;
+                slot.key = key;
+                slot.state.store(READY, std::memory_order_release);
+                m_size.fetch_add(1, std::memory_order_relaxed);
+                return slot;
+            }
+            continue; // lost the race; state now holds WRITING or READY for this slot
+        }
+        while (state == WRITING) {
+            std::this_thread::yield();
+            state = slot.state.load(std::memory_order_acquire);
+        }
+        if (slot.tag == tag && slot.key == key) {
+            return slot;
+        }
+
+        index = (index + 1) & (m_capacity - 1);
+        i++;
+    }
+
+    throw std::length_error("ConcurrentCounterTable is full");
+}
+
+/* Purpose: Adds delta to a key's count.
+ * Parameters:
+ *    key – string key to count
+ *    delta – amount to add (defaults to 1)
+ * Returns:
+ *    int64_t – the count after this increment
+ * Behavior:
+ *    Lock-free when the key already exists; a new key claims a slot first.
+ */
+int64_t ConcurrentCounterTable::increment(const std::string& key, const int64_t delta) {
+    return findOrClaim(key, hash(key)).count.fetch_add(delta, std::memory_order_relaxed) + delta;
+}
+
+/* Purpose: Retrieves the current count for a key.
+ * Parameters:
+ *    key – string key to lookup
+ * Returns:
+ *    optional<int64_t> containing the count if key exists, nullopt otherwise
+ */
+std::optional<int64_t> ConcurrentCounterTable::get(const std::string& key) const {
+    const Slot* slot = find(key, hash(key));
+    if (slot == nullptr) return std::nullopt;
+    return slot->count.load(std::memory_order_relaxed);
+}
+
+/* Purpose: Checks whether a key has been counted.
+ * Parameters:
+ *    key – string key to search
+ * Returns:
+ *    true if key exists, false otherwise
+ */
+bool ConcurrentCounterTable::contains(const std::string& key) const {
+    return find(key, hash(key)) != nullptr;
+}
+
+/* Purpose: Returns all keys published so far.
+ * Returns:
+ *    vector<string> containing every READY key
+ */
+std::vector<std::string> ConcurrentCounterTable::keys() const {
+    std::vector<std::string> keys;
+
+    for (size_t i = 0; i < m_capacity; i++) {
+        if (slots[i].state.load(std::memory_order_acquire) == READY) {
+            keys.push_back(slots[i].key);
+        }
+    }
+
+    return keys;
+}
+
+/* Purpose: Returns total number of slots in the table.
+ * Returns:
+ *    size_t – table capacity
+ */
+size_t ConcurrentCounterTable::capacity() const {
+    return m_capacity;
+}
+
+/* Purpose: Returns number of distinct keys in the table.
+ * Returns:
+ *    size_t – number of keys
+ */
+size_t ConcurrentCounterTable::size() const {
+    return m_size.load(std::memory_order_relaxed);
+}
+
+/* Purpose: Constructs a per-thread combining buffer.
+ * Parameters:
+ *    target – table the buffered counts are flushed to
+ *    flushThreshold – distinct keys buffered before add() flushes
+ */
+ConcurrentCounterTable::LocalBuffer::LocalBuffer(ConcurrentCounterTable& target, const size_t flushThreshold)
+    : target(target), flushThreshold(flushThreshold) {
+}
+
+/* Purpose: Flushes any buffered counts when the buffer goes out of scope.
+ * Behavior:
+ *    A destructor cannot report a failed flush, so errors (a full target
+ *    table, bad_alloc) are swallowed and the unflushed deltas are lost.
+ *    Call flush() before the buffer goes out of scope to see them.
+ */
+ConcurrentCounterTable::LocalBuffer::~LocalBuffer() {
+    try {
+        flush();
+    } catch (...) {
+    }
+}
+
+/* Purpose: Buffers an increment.
+ * Parameters:
+ *    key – string key to count
+ *    delta – amount to add (defaults to 1)
+ * Behavior:
+ *    Repeated keys combine into one pending delta. The buffer flushes once
+ *    it holds flushThreshold distinct keys or a delta nears int overflow.
+ */
+void ConcurrentCounterTable::LocalBuffer::add(const std::string& key, const int delta) {
+    const int pendingDelta = pending.merge(key, delta);
+    if (pending.size() >= flushThreshold || pendingDelta > (1 << 30) || pendingDelta < -(1 << 30)) {
+        flush();
+    }
+}
+
+/* Purpose: Applies every buffered delta to the target table and empties the buffer.
+ * Behavior:
+ *    Walks the buffered keys once on this thread. Each delta is zeroed in
+ *    the buffer as soon as the target has it, and zero deltas are skipped,
+ *    so a flush that throws partway can be retried without counting
+ *    anything twice. The buffer keeps its capacity.
+ * Throws:
+ *    length_error if the target has no room for a new key; the deltas
+ *    not yet added stay buffered
+ */
+void ConcurrentCounterTable::LocalBuffer::flush() {
+    if (pending.size() == 0) return;
+
+    for (const std::string& key : pending.keys()) {
+        int& delta = pending.findOrInsert(key);
+        if (delta == 0) continue;
+        target.findOrClaim(key, hash(key)).count.fetch_add(delta, std::memory_order_relaxed);
+        delta = 0;
+    }
+    pending.clear();
+}
@@ -0,0 +1,71 @@
+/*
+ * ConcurrentCounterTable.h
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "HashTable.h"
+
+class ConcurrentCounterTable {
+    private:
+        enum SlotState : uint8_t {EMPTY, WRITING, READY};
+
+        struct Slot {
+            std::atomic<uint8_t> state{EMPTY}; // EMPTY -> WRITING -> READY, never back
+            uint32_t tag = 0; // upper hash bits, checked before the key
+            std::string key; // immutable once the slot is READY
+            std::atomic<int64_t> count{0};
+        };
+
+        size_t m_capacity; // number of slots, a power of two
+        std::unique_ptr<Slot[]> slots; // fixed slot array; the table never resizes
+        std::atomic<size_t> m_size{0}; // number of READY slots
+
+        [[nodiscard]] static uint64_t hash(std::string_view key);
+
+        [[nodiscard]] const Slot* find(std::string_view key, uint64_t h) const;
+
+        Slot& findOrClaim(std::string_view key, uint64_t h);
+
+    public:
+        class LocalBuffer {
+            private:
+                ConcurrentCounterTable& target; // table the buffered deltas are flushed to
+                HashTable pending; // per-thread deltas for keys seen since the last flush
+                size_t flushThreshold; // distinct keys buffered before an automatic flush
+
+            public:
+                explicit LocalBuffer(ConcurrentCounterTable& target, size_t flushThreshold = 1024);
+                LocalBuffer(const LocalBuffer&) = delete;
+                LocalBuffer& operator=(const LocalBuffer&) = delete;
+                ~LocalBuffer();
+
+                void add(const std::string& key, int delta = 1);
+
+                void flush();
+        };
+
+        static constexpr double MAX_LOAD_FACTOR = 0.75;
+
+        explicit ConcurrentCounterTable(size_t expectedKeys);
+
+        ConcurrentCounterTable(const ConcurrentCounterTable&) = delete;
+        ConcurrentCounterTable& operator=(const ConcurrentCounterTable&) = delete;
+
+        int64_t increment(const std::string& key, int64_t delta = 1);
+
+        [[nodiscard]] std::optional<int64_t> get(const std::string& key) const;
+
+        [[nodiscard]] bool contains(const std::string& key) const;
+
+        [[nodiscard]] std::vector<std::string> keys() const;
+
+        [[nodiscard]] size_t capacity() const;
+
+        [[nodiscard]] size_t size() const;
+};
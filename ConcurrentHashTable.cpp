@@ -0,0 +1,423 @@
+/* Filename: ConcurrentHashTable.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements ConcurrentHashTable, a string-to-int
+ * hash table that many threads can read and update at once. Access goes through
+ * accessor objects that pin one entry, like operator[] references that stay safe
+ * while other threads run. Every entry carries its own spin bits: one writer bit
+ * and a reader count, so threads only wait for each other on the same key. Entries
+ * are separate nodes and the slot array holds pointers to them, in the style of
+ * TBB's concurrent_hash_map: a resize moves the pointers, never the entries, so it
+ * migrates around pinned entries instead of waiting for them. The slot array is
+ * guarded by a shared lock that is held only while a probe runs, never while an
+ * accessor is, so a thread may hold any number of accessors and still insert. A
+ * probe never waits for an entry while it holds that lock: if the entry it matched
+ * is busy, it drops the lock, yields and probes again, so a resize is never stuck
+ * behind a pinned entry.
+ */
+
+#include "ConcurrentHashTable.h"
+#include "HashFunctions.h"
+#include <mutex>
+#include <thread>
+#include <utility>
+
+/* Purpose: Constructs a concurrent hash table with initial capacity.
+ * Parameters:
+ *    initCapacity – number of slots to initially create (defaults to 8);
+ *                   rounded up to a power of two of at least 8
+ */
+ConcurrentHashTable::ConcurrentHashTable(const size_t initCapacity) : m_capacity(DEFAULT_INITIAL_CAPACITY) {
+    while (m_capacity < initCapacity) {
+        m_capacity *= 2;
+    }
+    slots = std::make_unique<std::atomic<Entry*>[]>(m_capacity);
+}
+
+/* Purpose: Frees every entry, erased ones included.
+ * Behavior:
+ *    No accessor may outlive the table.
+ */
+ConcurrentHashTable::~ConcurrentHashTable() {
+    for (size_t i = 0; i < m_capacity; i++) {
+        delete slots[i].load(std::memory_order_relaxed);
+    }
+}
+
+/* Purpose: Computes the full hash of a key.
+ * Parameters:
+ *    key – string key to hash
+ * Returns:
+ *    uint64_t – full hash; low bits pick the slot, all bits are compared before the key
+ */
+uint64_t ConcurrentHashTable::hash(const std::string& key) {
+    return mix64(fnv1a64(key));
+}
+
+/* Purpose: Tries to take an entry's spin bits for reading.
+ * Returns:
+ *    true if taken, false if a writer holds the entry
+ * Behavior:
+ *    Any number of readers may hold an entry at once.
+ */
+bool ConcurrentHashTable::tryLockRead(Entry& entry) {
+    uint32_t bits = entry.lockBits.load(std::memory_order_relaxed);
+    while ((bits & WRITER) == 0) {
+        if (entry.lockBits.compare_exchange_weak(bits, bits + 1, std::memory_order_acquire,
+                                                 std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Purpose: Tries to take an entry's spin bits for writing.
+ * Returns:
+ *    true if taken, false if the entry has readers or a writer
+ */
+bool ConcurrentHashTable::tryLockWrite(Entry& entry) {
+    uint32_t bits = 0;
+    return entry.lockBits.compare_exchange_strong(bits, WRITER, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+/* Purpose: Releases an entry's spin bits.
+ * Parameters:
+ *    writer – whether the bits were taken by tryLockWrite()
+ */
+void ConcurrentHashTable::unlock(Entry& entry, const bool writer) {
+    if (writer) {
+        entry.lockBits.store(0, std::memory_order_release);
+    } else {
+        entry.lockBits.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+/* Purpose: Finds a key's READY entry and locks it.
+ * Parameters:
+ *    key – string key to search
+ *    h – hash of key
+ *    writer – lock for writing rather than reading
+ *    lock – the caller's shared lock on resizeMutex, held on entry and exit
+ * Returns:
+ *    pointer to the locked entry, or nullptr if the key is not in the table
+ * Behavior:
+ *    The probe itself takes no locks. If the match is busy, lock is dropped
+ *    while this thread yields, so a resize can run, and the probe starts
+ *    over. After locking a match the state is checked again: if the key was
+ *    erased in the meantime, the probe moves on past the DELETED entry.
+ */
+ConcurrentHashTable::Entry* ConcurrentHashTable::findLocked(const std::string& key, const uint64_t h,
+                                                            const bool writer,
+                                                            std::shared_lock<std::shared_mutex>& lock) const {
+    for (;;) {
+        const size_t mask = m_capacity - 1;
+        for (size_t index = h & mask;; index = (index + 1) & mask) {
+            Entry* entry = slots[index].load(std::memory_order_acquire);
+            if (entry == nullptr) return nullptr;
+            if (entry->hash != h || entry->key != key || entry->state.load(std::memory_order_relaxed) != READY) {
+                continue;
+            }
+            if (!(writer ? tryLockWrite(*entry) : tryLockRead(*entry))) break;
+            if (entry->state.load(std::memory_order_relaxed) == READY) return entry;
+            unlock(*entry, writer);
+        }
+
+        lock.unlock();
+        std::this_thread::yield();
+        lock.lock();
+    }
+}
+
+/* Purpose: Grows the slot array and frees DELETED entries.
+ * Parameters:
+ *    seenCapacity – capacity the caller found full
+ * Behavior:
+ *    Takes resizeMutex exclusively, so it waits only for probes in
+ *    progress; pinned entries keep their address and stay pinned. Does
+ *    nothing if another thread resized since the caller looked. The new
+ *    array keeps the live keys at most a quarter full. No accessor can
+ *    hold a DELETED entry, as erase() takes the write lock first.
+ */
+void ConcurrentHashTable::resize(const size_t seenCapacity) {
+    std::unique_lock lock(resizeMutex);
+    if (m_capacity != seenCapacity) return;
+
+    const size_t liveKeys = m_size.load(std::memory_order_relaxed);
+    size_t newCapacity = DEFAULT_INITIAL_CAPACITY;
+    while ((liveKeys + 1) * 4 > newCapacity) {
+        newCapacity *= 2;
+    }
+
+    auto newSlots = std::make_unique<std::atomic<Entry*>[]>(newCapacity);
+    for (size_t i = 0; i < m_capacity; i++) {
+        Entry* entry = slots[i].load(std::memory_order_relaxed);
+        if (entry == nullptr) continue;
+        if (entry->state.load(std::memory_order_relaxed) == DELETED) {
+            delete entry;
+            continue;
+        }
+
+        size_t index = entry->hash & (newCapacity - 1);
+        while (newSlots[index].load(std::memory_order_relaxed) != nullptr) {
+            index = (index + 1) & (newCapacity - 1);
+        }
+        newSlots[index].store(entry, std::memory_order_relaxed);
+    }
+    slots = std::move(newSlots);
+    m_capacity = newCapacity;
+    m_used.store(liveKeys, std::memory_order_relaxed);
+}
+
+/* Purpose: Releases the entry pinned by an accessor, if any.
+ */
+ConcurrentHashTable::ConstAccessor::~ConstAccessor() {
+    release();
+}
+
+/* Purpose: Checks whether the accessor pins an entry.
+ * Returns:
+ *    true if no entry is pinned
+ */
+bool ConcurrentHashTable::ConstAccessor::empty() const {
+    return entry == nullptr;
+}
+
+/* Purpose: Returns the key of the pinned entry.
+ * Behavior:
+ *    The accessor must not be empty.
+ */
+const std::string& ConcurrentHashTable::ConstAccessor::key() const {
+    return entry->key;
+}
+
+/* Purpose: Reads the value of the pinned entry.
+ * Behavior:
+ *    The accessor must not be empty.
+ */
+const int& ConcurrentHashTable::ConstAccessor::operator*() const {
+    return entry->value;
+}
+
+/* Purpose: Unpins the entry, letting other accessors of it proceed.
+ * Behavior:
+ *    Does nothing if the accessor is already empty.
+ */
+void ConcurrentHashTable::ConstAccessor::release() {
+    if (entry != nullptr) {
+        unlock(*entry, writer);
+        entry = nullptr;
+    }
+}
+
+/* Purpose: Gives write access to the value of the pinned entry.
+ * Behavior:
+ *    The accessor must not be empty.
+ */
+int& ConcurrentHashTable::Accessor::operator*() const {
+    return entry->value;
+}
+
+/* Purpose: Pins a key's entry for reading.
+ * Parameters:
+ *    result – accessor to pin the entry with; released first
+ *    key – string key to search
+ * Returns:
+ *    true if the key was found, in which case result holds it
+ * Behavior:
+ *    Other readers of the key go ahead; writers wait until result is released.
+ *    A thread may hold any number of accessors, and may read a key again
+ *    while it holds it for reading, but not while it holds it for writing.
+ */
+bool ConcurrentHashTable::find(ConstAccessor& result, const std::string& key) const {
+    result.release();
+    std::shared_lock lock(resizeMutex);
+
+    Entry* entry = findLocked(key, hash(key), false, lock);
+    if (entry == nullptr) return false;
+
+    result.entry = entry;
+    result.writer = false;
+    return true;
+}
+
+/* Purpose: Pins a key's entry for writing.
+ * Parameters:
+ *    result – accessor to pin the entry with; released first
+ *    key – string key to search
+ * Returns:
+ *    true if the key was found, in which case result holds it
+ * Behavior:
+ *    Every other accessor of the key waits until result is released, so a
+ *    thread must not ask for a key it already holds.
+ */
+bool ConcurrentHashTable::find(Accessor& result, const std::string& key) {
+    result.release();
+    std::shared_lock lock(resizeMutex);
+
+    Entry* entry = findLocked(key, hash(key), true, lock);
+    if (entry == nullptr) return false;
+
+    result.entry = entry;
+    result.writer = true;
+    return true;
+}
+
+/* Purpose: Pins a key's entry for writing, inserting the key if it is missing.
+ * Parameters:
+ *    result – accessor to pin the entry with; released first
+ *    key – string key to find or insert
+ *    value – value stored if the key is inserted (defaults to 0)
+ * Returns:
+ *    true if the key was inserted, false if it already existed;
+ *    either way result holds the key's entry
+ * Behavior:
+ *    This is the thread-safe form of HashTable::operator[]. The probe runs
+ *    without locks. A matching entry is locked and checked again. At the
+ *    first EMPTY slot a new entry, already write-locked, is published with
+ *    a compare-exchange; if another thread claims the slot first, its entry
+ *    is checked like any other, as it may hold this same key. Because
+ *    erased slots are never reused before a resize, the first EMPTY slot of
+ *    a probe is the only place a key can be inserted. When half the slots
+ *    are used the table resizes, even if this thread holds other accessors;
+ *    they keep their entries. A thread must not insert a key it holds.
+ */
+bool ConcurrentHashTable::insert(Accessor& result, const std::string& key, const int value) {
+    result.release();
+    const uint64_t h = hash(key);
+    std::unique_ptr<Entry> fresh; // built at the first EMPTY slot, kept if that slot is lost
+
+    for (;;) {
+        std::shared_lock lock(resizeMutex);
+        const size_t seenCapacity = m_capacity;
+        bool full = false;
+
+        for (size_t index = h & (seenCapacity - 1);; index = (index + 1) & (seenCapacity - 1)) {
+            std::atomic<Entry*>& slot = slots[index];
+            Entry* entry = slot.load(std::memory_order_acquire);
+
+            if (entry == nullptr) {
+                if (!fresh) {
+                    fresh = std::make_unique<Entry>();
+                    fresh->hash = h;
+                    fresh->key = key;
+                }
+                if ((m_used.fetch_add(1, std::memory_order_relaxed) + 1) * 2 > seenCapacity) {
+                    m_used.fetch_sub(1, std::memory_order_relaxed);
+                    full = true;
+                    break;
+                }
+                fresh->value = value;
+                fresh->lockBits.store(WRITER, std::memory_order_relaxed);
+                if (slot.compare_exchange_strong(entry, fresh.get(), std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+                    m_size.fetch_add(1, std::memory_order_relaxed);
+                    result.entry = fresh.release();
+                    result.writer = true;
+                    return true;
+                }
+                m_used.fetch_sub(1, std::memory_order_relaxed);
+                // lost the race for this slot; entry is the winner, which may hold this key
+            }
+
+            if (entry->hash == h && entry->key == key && entry->state.load(std::memory_order_relaxed) == READY) {
+                if (!tryLockWrite(*entry)) break;
+                if (entry->state.load(std::memory_order_relaxed) == READY) {
+                    result.entry = entry;
+                    result.writer = true;
+                    return false;
+                }
+                unlock(*entry, true); // erased while this thread looked; probe on
+            }
+        }
+
+        lock.unlock();
+        if (full) {
+            resize(seenCapacity);
+        } else {
+            std::this_thread::yield(); // the key's entry is pinned; probe again once it may be free
+        }
+    }
+}
+
+/* Purpose: Inserts a key-value pair into the hash table.
+ * Parameters:
+ *    key – string key to insert
+ *    value – integer value to associate with key
+ * Returns:
+ *    true if insertion succeeded, false if key already exists
+ * Behavior:
+ *    Resizes as needed even while this thread holds accessors, but must
+ *    not be called for a key this thread holds.
+ */
+bool ConcurrentHashTable::insert(const std::string& key, const int value) {
+    Accessor accessor;
+    return insert(accessor, key, value);
+}
+
+/* Purpose: Removes a key-value pair from the hash table.
+ * Parameters:
+ *    key – string key to remove
+ * Returns:
+ *    true if key was found and removed, false otherwise
+ * Behavior:
+ *    Waits for every accessor of the key to be released, so a thread must
+ *    not erase a key it holds. The entry stays in its slot as DELETED,
+ *    keeping probe chains intact, until the next resize frees it.
+ */
+bool ConcurrentHashTable::erase(const std::string& key) {
+    std::shared_lock lock(resizeMutex); // held until the entry is unlocked, so no resize frees it first
+
+    Entry* entry = findLocked(key, hash(key), true, lock);
+    if (entry == nullptr) return false;
+
+    entry->state.store(DELETED, std::memory_order_relaxed);
+    m_size.fetch_sub(1, std::memory_order_relaxed);
+    unlock(*entry, true);
+    return true;
+}
+
+/* Purpose: Retrieves the value associated with a key.
+ * Parameters:
+ *    key – string key to lookup
+ * Returns:
+ *    optional<int> containing value if key exists, nullopt otherwise
+ */
+std::optional<int> ConcurrentHashTable::get(const std::string& key) const {
+    ConstAccessor accessor;
+    if (!find(accessor, key)) return std::nullopt;
+    return *accessor;
+}
+
+/* Purpose: Returns all keys currently in the hash table.
+ * Returns:
+ *    vector<string> containing every READY key, in slot order
+ */
+std::vector<std::string> ConcurrentHashTable::keys() const {
+    std::shared_lock lock(resizeMutex);
+    std::vector<std::string> keys;
+
+    for (size_t i = 0; i < m_capacity; i++) {
+        const Entry* entry = slots[i].load(std::memory_order_acquire);
+        if (entry != nullptr && entry->state.load(std::memory_order_relaxed) == READY) {
+            keys.push_back(entry->key);
+        }
+    }
+
+    return keys;
+}
+
+/* Purpose: Returns total number of slots in the table.
+ * Returns:
+ *    size_t – slot count, a power of two
+ */
+size_t ConcurrentHashTable::capacity() const {
+    std::shared_lock lock(resizeMutex);
+    return m_capacity;
+}
+
+/* Purpose: Returns number of key-value pairs in the table.
+ * Returns:
+ *    size_t – number of keys
+ */
+size_t ConcurrentHashTable::size() const {
+    return m_size.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,103 @@
+/*
+ * ConcurrentHashTable.h
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// A thread may hold any number of accessors and keep inserting while it does, but
+// must not ask for a key it already holds, except to read one it holds for reading.
+class ConcurrentHashTable {
+    private:
+        enum EntryState : uint8_t {READY, DELETED}; // READY -> DELETED; a resize frees DELETED entries
+
+        // one key-value pair; it never moves, so an accessor holding it survives a resize
+        struct Entry {
+            std::atomic<uint8_t> state{READY};
+            std::atomic<uint32_t> lockBits{0}; // WRITER bit plus a count of readers
+            uint64_t hash = 0; // full hash, checked before the key
+            std::string key; // immutable once the entry is published
+            int value = 0; // guarded by lockBits
+        };
+
+        static constexpr uint32_t WRITER = uint32_t{1} << 31;
+
+        size_t m_capacity; // number of slots, a power of two
+        std::unique_ptr<std::atomic<Entry*>[]> slots; // nullptr while a slot is EMPTY
+        std::atomic<size_t> m_size{0}; // READY entries
+        std::atomic<size_t> m_used{0}; // slots holding READY or DELETED entries; a resize clears DELETED ones
+        mutable std::shared_mutex resizeMutex; // shared while a probe runs, exclusive for resize()
+
+        [[nodiscard]] static uint64_t hash(const std::string& key);
+
+        [[nodiscard]] static bool tryLockRead(Entry& entry);
+
+        [[nodiscard]] static bool tryLockWrite(Entry& entry);
+
+        static void unlock(Entry& entry, bool writer);
+
+        [[nodiscard]] Entry* findLocked(const std::string& key, uint64_t h, bool writer,
+                                        std::shared_lock<std::shared_mutex>& lock) const;
+
+        void resize(size_t seenCapacity);
+
+    public:
+        // pins one entry for reading; the entry cannot change while it is held
+        class ConstAccessor {
+            private:
+                friend class ConcurrentHashTable;
+                Entry* entry = nullptr;
+                bool writer = false;
+
+            public:
+                ConstAccessor() = default;
+                ConstAccessor(const ConstAccessor&) = delete;
+                ConstAccessor& operator=(const ConstAccessor&) = delete;
+                ~ConstAccessor();
+
+                [[nodiscard]] bool empty() const;
+
+                [[nodiscard]] const std::string& key() const;
+
+                [[nodiscard]] const int& operator*() const;
+
+                void release();
+        };
+
+        // pins one entry for writing; other accessors to it wait until release()
+        class Accessor : public ConstAccessor {
+            public:
+                [[nodiscard]] int& operator*() const;
+        };
+
+        static constexpr size_t DEFAULT_INITIAL_CAPACITY = 8;
+
+        explicit ConcurrentHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY);
+
+        ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+        ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+        ~ConcurrentHashTable();
+
+        bool find(ConstAccessor& result, const std::string& key) const;
+
+        bool find(Accessor& result, const std::string& key);
+
+        bool insert(Accessor& result, const std::string& key, int value = 0);
+
+        bool insert(const std::string& key, int value);
+
+        bool erase(const std::string& key);
+
+        [[nodiscard]] std::optional<int> get(const std::string& key) const;
+
+        [[nodiscard]] std::vector<std::string> keys() const;
+
+        [[nodiscard]] size_t capacity() const;
+
+        [[nodiscard]] size_t size() const;
+};
@@ -0,0 +1,135 @@
+/*
+ * ConstexprHashTable.h
+ *
+ * A hash table for key sets known at build time. The table is built entirely
+ * during compilation: the constructor searches for a hash seed under which no
+ * two keys share a slot, so every lookup is one hash and one comparison, and a
+ * lookup on a literal key folds to a constant. Intended for small sets (tens
+ * to a few hundred keys); use FrozenHashTable for large static data.
+ */
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include "HashFunctions.h"
+
+/* Purpose: Returns the smallest power of two that is at least n.
+ */
+constexpr size_t nextPowerOfTwo(const size_t n) {
+    size_t power = 1;
+    while (power < n) power *= 2;
+    return power;
+}
+
+/* Purpose: Default slot count for N keys.
+ * Behavior:
+ *    About N*N/4 slots gives a collision-free seed within a handful of
+ *    attempts while staying small for the set sizes this table targets.
+ */
+constexpr size_t defaultConstexprCapacity(const size_t n) {
+    return nextPowerOfTwo(n * n / 4 > 2 * n ? n * n / 4 : 2 * n);
+}
+
+template <size_t N, size_t Capacity = defaultConstexprCapacity(N)>
+class ConstexprHashTable {
+    private:
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+        static_assert(Capacity >= N, "Capacity must hold every key");
+
+        static constexpr uint64_t MAX_SEED_ATTEMPTS = 100000;
+
+        std::array<std::string_view, Capacity> slotKeys{}; // key stored in each slot
+        std::array<int, Capacity> slotValues{}; // value stored in each slot
+        std::array<bool, Capacity> occupied{}; // whether each slot holds a key
+        uint64_t m_seed = 0; // seed under which the keys do not collide
+
+        /* Purpose: Returns a key's slot under a seed.
+         */
+        [[nodiscard]] static constexpr size_t slotFor(const std::string_view key, const uint64_t seed) {
+            return mix64(fnv1a64(key) ^ (seed * 0x9e3779b97f4a7c15ULL)) & (Capacity - 1);
+        }
+
+    public:
+        using Entry = std::pair<std::string_view, int>;
+
+        /* Purpose: Builds the table at compile time.
+         * Parameters:
+         *    entries – brace-enclosed list of {key, value} pairs
+         * Behavior:
+         *    Tries seeds in order until every key lands in its own slot.
+         *    A duplicate key, or no collision-free seed within the search
+         *    limit (raise Capacity), is a compile error.
+         */
+        consteval ConstexprHashTable(const Entry (&entries)[N]) {
+            for (size_t i = 0; i < N; i++) {
+                for (size_t j = i + 1; j < N; j++) {
+                    if (entries[i].first == entries[j].first) throw std::invalid_argument("duplicate key");
+                }
+            }
+
+            for (uint64_t seed = 0; seed < MAX_SEED_ATTEMPTS; seed++) {
+                std::array<bool, Capacity> used{};
+                bool collisionFree = true;
+                for (size_t i = 0; i < N && collisionFree; i++) {
+                    const size_t slot = slotFor(entries[i].first, seed);
+                    collisionFree = !used[slot];
+                    used[slot] = true;
+                }
+                if (collisionFree) {
+                    m_seed = seed;
+                    for (size_t i = 0; i < N; i++) {
+                        const size_t slot = slotFor(entries[i].first, seed);
+                        slotKeys[slot] = entries[i].first;
+                        slotValues[slot] = entries[i].second;
+                        occupied[slot] = true;
+                    }
+                    return;
+                }
+            }
+
+            throw std::length_error("no collision-free seed found; increase Capacity");
+        }
+
+        /* Purpose: Checks whether the table contains a key.
+         * Returns:
+         *    true if key exists, false otherwise
+         */
+        [[nodiscard]] constexpr bool contains(const std::string_view key) const {
+            const size_t slot = slotFor(key, m_seed);
+            return occupied[slot] && slotKeys[slot] == key;
+        }
+
+        /* Purpose: Retrieves the value associated with a key.
+         * Returns:
+         *    optional<int> containing value if key exists, nullopt otherwise
+         */
+        [[nodiscard]] constexpr std::optional<int> get(const std::string_view key) const {
+            const size_t slot = slotFor(key, m_seed);
+            if (!occupied[slot] || slotKeys[slot] != key) return std::nullopt;
+            return slotValues[slot];
+        }
+
+        /* Purpose: Returns number of key-value pairs in the table.
+         */
+        [[nodiscard]] constexpr size_t size() const {
+            return N;
+        }
+
+        /* Purpose: Returns total number of slots in the table.
+         */
+        [[nodiscard]] constexpr size_t capacity() const {
+            return Capacity;
+        }
+
+        /* Purpose: Returns the hash seed chosen at compile time.
+         */
+        [[nodiscard]] constexpr uint64_t seed() const {
+            return m_seed;
+        }
+};
+
+template <size_t N>
+ConstexprHashTable(const std::pair<std::string_view, int> (&)[N]) -> ConstexprHashTable<N>;
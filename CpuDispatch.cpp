@@ -0,0 +1,162 @@
+/* Filename: CpuDispatch.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements run-time CPU feature detection for
+ * the hash and key-compare kernels. The features are read once. The widest
+ * kernel level the CPU supports is then used, unless the HASHTABLE_KERNEL
+ * environment variable names another one. One binary can therefore run on
+ * every machine in a fleet, and tests can force each kernel in turn.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include "CpuDispatch.h"
+
+#if defined(CPU_DISPATCH_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+/* Purpose: Queries the CPU (and, for AVX, the OS) for supported extensions.
+ * Returns:
+ *    CpuFeatures – the detected extensions
+ */
+CpuFeatures detectFeatures() {
+    CpuFeatures features;
+#if defined(CPU_DISPATCH_X86) && defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    features.sse2 = (info[3] & (1 << 26)) != 0;
+    features.sse42 = (info[2] & (1 << 20)) != 0;
+    const bool osXsave = (info[2] & (1 << 27)) != 0;
+    const unsigned long long xcr0 = osXsave ? _xgetbv(0) : 0;
+    __cpuidex(info, 7, 0);
+    features.avx2 = (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+    features.avx512bw = (xcr0 & 0xe6) == 0xe6 && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+    features.bmi2 = (info[1] & (1 << 8)) != 0;
+#elif defined(CPU_DISPATCH_X86)
+    // libgcc's checks include the OS's XSAVE support for the AVX states
+    __builtin_cpu_init();
+    features.sse2 = __builtin_cpu_supports("sse2");
+    features.sse42 = __builtin_cpu_supports("sse4.2");
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.avx512bw = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    features.bmi2 = __builtin_cpu_supports("bmi2");
+#elif defined(CPU_DISPATCH_NEON)
+    features.neon = true; // Advanced SIMD is mandatory on AArch64
+#endif
+    return features;
+}
+
+/* Purpose: Picks the dispatch level at startup.
+ * Returns:
+ *    CpuLevel – the level named by HASHTABLE_KERNEL if it is known and
+ *    supported, else bestCpuLevel()
+ * Behavior:
+ *    Writes a one-line notice to stderr when the override cannot be used;
+ *    the test suite keys on "not supported on this CPU" to skip a run.
+ */
+CpuLevel selectLevel() {
+    const char* requested = std::getenv(KERNEL_ENV_VAR);
+    if (requested == nullptr || *requested == '\0') return bestCpuLevel();
+
+    const std::optional<CpuLevel> level = parseCpuLevel(requested);
+    if (!level) {
+        std::cerr << KERNEL_ENV_VAR << "=" << requested << " is not a known kernel; using "
+                << cpuLevelName(bestCpuLevel()) << std::endl;
+        return bestCpuLevel();
+    }
+    if (!cpuLevelSupported(*level)) {
+        std::cerr << KERNEL_ENV_VAR << "=" << requested << " is not supported on this CPU; using "
+                << cpuLevelName(bestCpuLevel()) << std::endl;
+        return bestCpuLevel();
+    }
+    return *level;
+}
+
+} // namespace
+
+/* Purpose: Returns the extensions this machine supports.
+ * Returns:
+ *    const CpuFeatures& – detected on first use
+ */
+const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = detectFeatures();
+    return features;
+}
+
+/* Purpose: Checks whether every kernel of a level can run here.
+ * Parameters:
+ *    level – level to check
+ * Returns:
+ *    true if the CPU has all the extensions the level's kernels use
+ */
+bool cpuLevelSupported(const CpuLevel level) {
+    const CpuFeatures& features = cpuFeatures();
+    switch (level) {
+        case CpuLevel::SCALAR:
+            return true;
+        case CpuLevel::SSE2:
+            return features.sse2;
+        case CpuLevel::SSE42:
+            return features.sse2 && features.sse42;
+        case CpuLevel::AVX2:
+            return features.sse42 && features.avx2;
+        case CpuLevel::AVX512:
+            return features.avx2 && features.avx512bw;
+        case CpuLevel::NEON:
+            return features.neon;
+    }
+    return false;
+}
+
+/* Purpose: Returns the widest level this CPU supports.
+ */
+CpuLevel bestCpuLevel() {
+    for (const CpuLevel level : {CpuLevel::NEON, CpuLevel::AVX512, CpuLevel::AVX2, CpuLevel::SSE42, CpuLevel::SSE2}) {
+        if (cpuLevelSupported(level)) return level;
+    }
+    return CpuLevel::SCALAR;
+}
+
+/* Purpose: Returns the level every dispatched kernel uses.
+ * Returns:
+ *    CpuLevel – chosen by selectLevel() on first use and fixed afterwards
+ */
+CpuLevel dispatchLevel() {
+    static const CpuLevel level = selectLevel();
+    return level;
+}
+
+/* Purpose: Returns a level's name, as accepted by HASHTABLE_KERNEL.
+ */
+const char* cpuLevelName(const CpuLevel level) {
+    switch (level) {
+        case CpuLevel::SSE2:
+            return "sse2";
+        case CpuLevel::SSE42:
+            return "sse42";
+        case CpuLevel::AVX2:
+            return "avx2";
+        case CpuLevel::AVX512:
+            return "avx512";
+        case CpuLevel::NEON:
+            return "neon";
+        default:
+            return "scalar";
+    }
+}
+
+/* Purpose: Parses a level name.
+ * Parameters:
+ *    name – a name returned by cpuLevelName()
+ * Returns:
+ *    optional<CpuLevel> – the level, or nullopt if the name is unknown
+ */
+std::optional<CpuLevel> parseCpuLevel(const std::string_view name) {
+    for (const CpuLevel level : ALL_CPU_LEVELS) {
+        if (name == cpuLevelName(level)) return level;
+    }
+    return std::nullopt;
+}
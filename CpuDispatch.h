@@ -0,0 +1,50 @@
+/*
+ * CpuDispatch.h
+ */
+#pragma once
+#include <optional>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CPU_DISPATCH_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CPU_DISPATCH_NEON 1
+#endif
+
+// compiles one function for an instruction set the rest of the build does not assume
+#if defined(__GNUC__) || defined(__clang__)
+#define CPU_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CPU_TARGET(isa)
+#endif
+
+// kernel levels; the x86 ones are ordered, each implying the ones before it
+enum class CpuLevel {SCALAR, SSE2, SSE42, AVX2, AVX512, NEON};
+
+// instruction set extensions detected on this machine
+struct CpuFeatures {
+    bool sse2 = false;
+    bool sse42 = false;
+    bool avx2 = false;
+    bool avx512bw = false; // with AVX-512F and OS support for the ZMM state
+    bool bmi2 = false;
+    bool neon = false;
+};
+
+inline constexpr CpuLevel ALL_CPU_LEVELS[] = {CpuLevel::SCALAR, CpuLevel::SSE2, CpuLevel::SSE42, CpuLevel::AVX2,
+                                              CpuLevel::AVX512, CpuLevel::NEON};
+
+// environment variable that overrides the dispatch level, e.g. HASHTABLE_KERNEL=sse2
+inline constexpr const char* KERNEL_ENV_VAR = "HASHTABLE_KERNEL";
+
+[[nodiscard]] const CpuFeatures& cpuFeatures();
+
+[[nodiscard]] bool cpuLevelSupported(CpuLevel level);
+
+[[nodiscard]] CpuLevel bestCpuLevel();
+
+[[nodiscard]] CpuLevel dispatchLevel();
+
+[[nodiscard]] const char* cpuLevelName(CpuLevel level);
+
+[[nodiscard]] std::optional<CpuLevel> parseCpuLevel(std::string_view name);
@@ -0,0 +1,418 @@
+/* Filename: CuckooHashTable.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements CuckooHashTable, an alternative to
+ * HashTable with a bounded number of memory accesses per lookup. Every key lives
+ * in one of two 4-slot buckets chosen by two hash functions, or in a small stash,
+ * so get() and contains() read at most two buckets plus the stash. A bucket's tags,
+ * values and full hashes fill its first cache line; its keys take the next two and
+ * are read only when the full hash matches. When both buckets are full, insert()
+ * finds a chain of displacements with a breadth-first search over the stored hashes
+ * and moves keys along it, which keeps working at load factors above 90%. It
+ * exposes the same interface as HashTable.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include "CuckooHashTable.h"
+#include "HashFunctions.h"
+
+/* Purpose: Constructs a cuckoo hash table with initial capacity.
+ * Parameters:
+ *    initCapacity – number of slots to initially create (defaults to 8);
+ *                   rounded up to a power-of-two number of 4-slot buckets
+ */
+CuckooHashTable::CuckooHashTable(const size_t initCapacity) : m_buckets(2), m_size(0) {
+    while (m_buckets * SLOTS_PER_BUCKET < initCapacity) {
+        m_buckets *= 2;
+    }
+    table.resize(m_buckets);
+}
+
+/* Purpose: Computes the full hash of a key.
+ * Parameters:
+ *    key – string key to hash
+ * Returns:
+ *    uint64_t – hash whose halves select the two buckets and whose top byte is the tag
+ */
+uint64_t CuckooHashTable::hash(const std::string& key) {
+    return mix64(fnv1a64(key));
+}
+
+/* Purpose: Derives the 8-bit tag stored for a key.
+ * Parameters:
+ *    h – hash of the key
+ * Returns:
+ *    uint8_t – nonzero tag, so EMPTY_TAG can mark free slots
+ */
+uint8_t CuckooHashTable::tagOf(const uint64_t h) {
+    const uint8_t tag = static_cast<uint8_t>(h >> 56);
+    return tag == EMPTY_TAG ? 1 : tag;
+}
+
+/* Purpose: Returns a key's first candidate bucket.
+ */
+size_t CuckooHashTable::primaryBucket(const uint64_t h) const {
+    return h & (m_buckets - 1);
+}
+
+/* Purpose: Returns a key's second candidate bucket.
+ * Behavior:
+ *    Uses the high half of the hash, so the two buckets are independent;
+ *    if they coincide the neighbouring bucket is used instead.
+ */
+size_t CuckooHashTable::alternateBucket(const uint64_t h) const {
+    const size_t second = (h >> 32) & (m_buckets - 1);
+    return second == primaryBucket(h) ? second ^ 1 : second;
+}
+
+/* Purpose: Returns the candidate bucket of a stored key that it is not in.
+ * Parameters:
+ *    h – stored hash of the key
+ *    bucket – one of the key's two buckets
+ */
+size_t CuckooHashTable::otherBucket(const uint64_t h, const size_t bucket) const {
+    return primaryBucket(h) == bucket ? alternateBucket(h) : primaryBucket(h);
+}
+
+/* Purpose: Finds the value stored for a key.
+ * Parameters:
+ *    key – string key to search
+ *    h – hash of key
+ * Returns:
+ *    pointer to the value, or nullptr if key is not in the table
+ * Behavior:
+ *    Reads the tags of the two candidate buckets and, on a tag match, the
+ *    stored hash; keys are compared only when the full hash matches. The
+ *    stash is checked only when it is not empty.
+ */
+const int* CuckooHashTable::find(const std::string& key, const uint64_t h) const {
+    const uint8_t tag = tagOf(h);
+
+    for (const size_t b : {primaryBucket(h), alternateBucket(h)}) {
+        const Bucket& bucket = table[b];
+        for (size_t s = 0; s < SLOTS_PER_BUCKET; s++) {
+            if (bucket.tags[s] == tag && bucket.hashes[s] == h && bucket.keys[s] == key) {
+                return &bucket.values[s];
+            }
+        }
+    }
+
+    for (const auto& [stashedKey, value] : stash) {
+        if (stashedKey == key) return &value;
+    }
+
+    return nullptr;
+}
+
+/* Purpose: Non-const overload of find().
+ */
+int* CuckooHashTable::find(const std::string& key, const uint64_t h) {
+    return const_cast<int*>(std::as_const(*this).find(key, h));
+}
+
+/* Purpose: Stores a key in a free slot of a bucket.
+ * Returns:
+ *    pointer to the stored value, or nullptr if the bucket was full
+ * Behavior:
+ *    key is moved from only if it is stored.
+ */
+int* CuckooHashTable::placeInBucket(const size_t bucket, const uint64_t h, std::string&& key, const int value) {
+    Bucket& target = table[bucket];
+
+    for (size_t s = 0; s < SLOTS_PER_BUCKET; s++) {
+        if (target.tags[s] == EMPTY_TAG) {
+            target.tags[s] = tagOf(h);
+            target.hashes[s] = h;
+            target.keys[s] = std::move(key);
+            target.values[s] = value;
+            return &target.values[s];
+        }
+    }
+
+    return nullptr;
+}
+
+/* Purpose: Makes room for a key by moving other keys to their alternate buckets.
+ * Parameters:
+ *    key – key to insert
+ *    h – hash of key
+ *    value – value to insert
+ * Returns:
+ *    pointer to the stored value, or nullptr if no short enough path
+ *    exists, in which case key is not moved from
+ * Behavior:
+ *    Breadth-first search from both candidate buckets finds the shortest
+ *    chain of moves ending in a bucket with a free slot, taking each key's
+ *    other bucket from its stored hash. The chain is then applied from its
+ *    free end backwards, moving each key and its hash without rehashing,
+ *    so every key is always in one of its own buckets.
+ *    A move whose source no longer matches the path (the same bucket
+ *    appears twice) abandons the chain and reports failure.
+ */
+int* CuckooHashTable::displaceAndPlace(std::string&& key, const uint64_t h, const int value) {
+    std::vector<PathNode> nodes;
+    nodes.reserve(MAX_BFS_BUCKETS);
+    nodes.push_back({primaryBucket(h), NO_PARENT, 0});
+    nodes.push_back({alternateBucket(h), NO_PARENT, 0});
+
+    for (size_t n = 0; n < nodes.size(); n++) {
+        const Bucket& bucket = table[nodes[n].bucket];
+
+        if (std::find(bucket.tags.begin(), bucket.tags.end(), EMPTY_TAG) != bucket.tags.end()) {
+            // walk back from the free bucket, moving each parent's key one step forward
+            for (size_t child = n; nodes[child].parent != NO_PARENT; child = nodes[child].parent) {
+                const PathNode& step = nodes[child];
+                Bucket& from = table[nodes[step.parent].bucket];
+                if (from.tags[step.slot] == EMPTY_TAG ||
+                    otherBucket(from.hashes[step.slot], nodes[step.parent].bucket) != step.bucket) {
+                    return nullptr;
+                }
+                if (placeInBucket(step.bucket, from.hashes[step.slot], std::move(from.keys[step.slot]),
+                                  from.values[step.slot]) == nullptr) {
+                    return nullptr;
+                }
+                from.tags[step.slot] = EMPTY_TAG;
+            }
+
+            size_t root = n;
+            while (nodes[root].parent != NO_PARENT) root = nodes[root].parent;
+            return placeInBucket(nodes[root].bucket, h, std::move(key), value);
+        }
+
+        for (size_t s = 0; s < SLOTS_PER_BUCKET && nodes.size() < MAX_BFS_BUCKETS; s++) {
+            nodes.push_back({otherBucket(bucket.hashes[s], nodes[n].bucket), n, s});
+        }
+    }
+
+    return nullptr;
+}
+
+/* Purpose: Doubles the number of buckets and reinserts every key.
+ * Behavior:
+ *    Bucket keys are moved across and placed by their stored hashes.
+ *    Stashed keys, which store no hash, are hashed once and reinserted
+ *    too, so the stash usually empties.
+ */
+void CuckooHashTable::resize() {
+    std::vector<Bucket> oldTable = std::move(table);
+    std::vector<std::pair<std::string, int>> oldStash = std::move(stash);
+    m_buckets *= 2;
+    table = std::vector<Bucket>(m_buckets);
+    stash.clear();
+    m_size = 0;
+
+    for (Bucket& bucket : oldTable) {
+        for (size_t s = 0; s < SLOTS_PER_BUCKET; s++) {
+            if (bucket.tags[s] != EMPTY_TAG) {
+                insertNew(std::move(bucket.keys[s]), bucket.hashes[s], bucket.values[s]);
+            }
+        }
+    }
+    for (auto& [key, value] : oldStash) {
+        const uint64_t h = hash(key);
+        insertNew(std::move(key), h, value);
+    }
+}
+
+/* Purpose: Inserts a key known not to be in the table.
+ * Parameters:
+ *    key – key to insert
+ *    h – hash of key
+ *    value – value to insert
+ * Returns:
+ *    reference to the stored value
+ * Behavior:
+ *    Tries the two buckets, then a displacement path, then the stash, and
+ *    finally grows the table and starts over. key is moved into whichever
+ *    place takes it; the key is never hashed or looked up again.
+ */
+int& CuckooHashTable::insertNew(std::string&& key, const uint64_t h, const int value) {
+    int* stored = placeInBucket(primaryBucket(h), h, std::move(key), value);
+    if (stored == nullptr) stored = placeInBucket(alternateBucket(h), h, std::move(key), value);
+    if (stored == nullptr) stored = displaceAndPlace(std::move(key), h, value);
+    if (stored != nullptr) {
+        m_size++;
+        return *stored;
+    }
+
+    if (stash.size() < STASH_CAPACITY) {
+        stash.emplace_back(std::move(key), value);
+        m_size++;
+        return stash.back().second;
+    }
+
+    resize();
+    return insertNew(std::move(key), h, value);
+}
+
+/* Purpose: Inserts a key-value pair into the hash table.
+ * Parameters:
+ *    key – string key to insert
+ *    value – integer value to associate with key
+ * Returns:
+ *    true if insertion succeeded, false if key already exists
+ * Behavior:
+ *    Hashes the key once, for the lookup and the insert both.
+ */
+bool CuckooHashTable::insert(const std::string& key, const int value) {
+    const uint64_t h = hash(key);
+    if (find(key, h) != nullptr) return false;
+    insertNew(std::string(key), h, value);
+    return true;
+}
+
+/* Purpose: Removes a key-value pair from the table.
+ * Parameters:
+ *    key – string key to remove
+ * Returns:
+ *    true if removal succeeded, false if key not found
+ * Behavior:
+ *    Clears the slot's tag; cuckoo hashing needs no tombstones.
+ */
+bool CuckooHashTable::remove(const std::string& key) {
+    const uint64_t h = hash(key);
+    const uint8_t tag = tagOf(h);
+
+    for (const size_t b : {primaryBucket(h), alternateBucket(h)}) {
+        Bucket& bucket = table[b];
+        for (size_t s = 0; s < SLOTS_PER_BUCKET; s++) {
+            if (bucket.tags[s] == tag && bucket.hashes[s] == h && bucket.keys[s] == key) {
+                bucket.tags[s] = EMPTY_TAG;
+                bucket.keys[s].clear();
+                m_size--;
+                return true;
+            }
+        }
+    }
+
+    for (auto it = stash.begin(); it != stash.end(); ++it) {
+        if (it->first == key) {
+            stash.erase(it);
+            m_size--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Purpose: Checks whether the table contains a key.
+ * Parameters:
+ *    key – string key to search
+ * Returns:
+ *    true if key exists, false otherwise
+ */
+bool CuckooHashTable::contains(const std::string& key) const {
+    return find(key, hash(key)) != nullptr;
+}
+
+/* Purpose: Retrieves the value associated with a key.
+ * Parameters:
+ *    key – string key to lookup
+ * Returns:
+ *    optional<int> containing value if key exists, nullopt otherwise
+ */
+std::optional<int> CuckooHashTable::get(const std::string& key) const {
+    const int* value = find(key, hash(key));
+    if (value == nullptr) return std::nullopt;
+    return *value;
+}
+
+/* Purpose: Returns all keys currently in the hash table.
+ * Returns:
+ *    vector<string> containing all active keys
+ */
+std::vector<std::string> CuckooHashTable::keys() const {
+    std::vector<std::string> keys;
+
+    for (const Bucket& bucket : table) {
+        for (size_t s = 0; s < SLOTS_PER_BUCKET; s++) {
+            if (bucket.tags[s] != EMPTY_TAG) keys.push_back(bucket.keys[s]);
+        }
+    }
+    for (const auto& [key, value] : stash) {
+        keys.push_back(key);
+    }
+
+    return keys;
+}
+
+/* Purpose: Returns current load factor of the table.
+ * Returns:
+ *    double – ratio of size to slot capacity
+ */
+double CuckooHashTable::alpha() const {
+    return static_cast<double>(m_size) / static_cast<double>(capacity());
+}
+
+/* Purpose: Returns total number of slots in the table.
+ * Returns:
+ *    size_t – buckets times slots per bucket
+ */
+size_t CuckooHashTable::capacity() const {
+    return m_buckets * SLOTS_PER_BUCKET;
+}
+
+/* Purpose: Returns number of key-value pairs in the table.
+ * Returns:
+ *    size_t – number of entries
+ */
+size_t CuckooHashTable::size() const {
+    return m_size;
+}
+
+/* Purpose: Returns number of keys held in the overflow stash.
+ * Returns:
+ *    size_t – stash occupancy, at most 4
+ */
+size_t CuckooHashTable::stashSize() const {
+    return stash.size();
+}
+
+/* Purpose: Accesses value by key using bracket notation.
+ * Parameters:
+ *    key – string key to access
+ * Returns:
+ *    reference to the value associated with the key
+ * Behavior:
+ *    A missing key is inserted with value 0, like HashTable::operator[].
+ */
+int& CuckooHashTable::operator[](const std::string& key) {
+    const uint64_t h = hash(key);
+    int* value = find(key, h);
+    return value != nullptr ? *value : insertNew(std::string(key), h, 0);
+}
+
+/* Purpose: Prints the hash table to an output stream.
+ * Parameters:
+ *    os – output stream (e.g., cout)
+ * Behavior:
+ *    Prints all occupied slots in formatted form.
+ */
+std::ostream& operator<<(std::ostream& os, const CuckooHashTable& table) {
+    os << table.printMe();
+    return os;
+}
+
+/* Purpose: Returns a string representation of the hash table.
+ * Returns:
+ *    string – one line per occupied slot, then the stash
+ */
+std::string CuckooHashTable::printMe() const {
+    std::ostringstream out;
+
+    for (size_t b = 0; b < m_buckets; b++) {
+        for (size_t s = 0; s < SLOTS_PER_BUCKET; s++) {
+            if (table[b].tags[s] != EMPTY_TAG) {
+                out << "Bucket " << b << "." << s << ": <" << table[b].keys[s] << ", " << table[b].values[s] << ">\n";
+            }
+        }
+    }
+    for (const auto& [key, value] : stash) {
+        out << "Stash: <" << key << ", " << value << ">\n";
+    }
+
+    return out.str();
+}
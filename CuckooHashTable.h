@@ -0,0 +1,92 @@
+/*
+ * CuckooHashTable.h
+ */
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class CuckooHashTable {
+    private:
+        static constexpr size_t SLOTS_PER_BUCKET = 4;
+        static constexpr size_t STASH_CAPACITY = 4;
+        static constexpr size_t MAX_BFS_BUCKETS = 1 + 4 + 16 + 64 + 256; // displacement paths up to length 4
+        static constexpr uint8_t EMPTY_TAG = 0;
+
+        // tags, values and hashes fill the first cache line; the keys take two more and are
+        // read only when the full hash matches
+        struct alignas(64) Bucket {
+            std::array<uint8_t, SLOTS_PER_BUCKET> tags{}; // EMPTY_TAG or 8 hash bits
+            std::array<int, SLOTS_PER_BUCKET> values{};
+            std::array<uint64_t, SLOTS_PER_BUCKET> hashes{}; // full hash, so moving a key never rehashes it
+            alignas(64) std::array<std::string, SLOTS_PER_BUCKET> keys;
+        };
+
+        // node of the breadth-first search for a displacement path
+        struct PathNode {
+            size_t bucket; // bucket reached by this step
+            size_t parent; // index of the previous node, or NO_PARENT for the two home buckets
+            size_t slot; // slot of the parent bucket whose key moves into this bucket
+        };
+
+        static constexpr size_t NO_PARENT = static_cast<size_t>(-1);
+
+        size_t m_buckets; // number of buckets, a power of two
+        size_t m_size; // number of stored key-value pairs, including the stash
+        std::vector<Bucket> table; // bucket array
+        std::vector<std::pair<std::string, int>> stash; // overflow for keys no path could place
+
+        [[nodiscard]] static uint64_t hash(const std::string& key);
+
+        [[nodiscard]] static uint8_t tagOf(uint64_t h);
+
+        [[nodiscard]] size_t primaryBucket(uint64_t h) const;
+
+        [[nodiscard]] size_t alternateBucket(uint64_t h) const;
+
+        [[nodiscard]] size_t otherBucket(uint64_t h, size_t bucket) const;
+
+        [[nodiscard]] int* find(const std::string& key, uint64_t h);
+
+        [[nodiscard]] const int* find(const std::string& key, uint64_t h) const;
+
+        int* placeInBucket(size_t bucket, uint64_t h, std::string&& key, int value);
+
+        int* displaceAndPlace(std::string&& key, uint64_t h, int value);
+
+        void resize();
+
+        int& insertNew(std::string&& key, uint64_t h, int value);
+
+    public:
+        static constexpr size_t DEFAULT_INITIAL_CAPACITY = 8;
+
+        CuckooHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY); // default constructor
+
+        bool insert(const std::string& key, int value);
+
+        bool remove(const std::string& key);
+
+        [[nodiscard]] bool contains(const std::string& key) const;
+
+        [[nodiscard]] std::optional<int> get(const std::string& key) const;
+
+        [[nodiscard]] std::vector<std::string> keys() const;
+
+        [[nodiscard]] double alpha() const;
+
+        [[nodiscard]] size_t capacity() const;
+
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] size_t stashSize() const;
+
+        int& operator[](const std::string& key);
+
+        friend std::ostream& operator<<(std::ostream& os, const CuckooHashTable& hashTable);
+
+        [[nodiscard]] std::string printMe() const;
+};
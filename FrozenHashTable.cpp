@@ -0,0 +1,544 @@
+/* Filename: FrozenHashTable.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements FrozenHashTable, an immutable,
+ * read-optimized table produced by HashTable::freeze(). Keys are placed with a
+ * minimal perfect hash function in the style of PTHash: each key hashes to a small
+ * bucket, and every bucket stores a "pilot" value, found at build time, that sends
+ * all of the bucket's keys to distinct slots. Pilots address 2% more slots than
+ * there are keys, and the few keys that land past the end are remapped into the
+ * gaps, so exactly one slot per key is stored. A lookup is one hash, one pilot read
+ * and one key comparison. Keys, values and pilots are packed into a single
+ * contiguous image that can be saved to a file and later loaded or memory-mapped
+ * without any rebuilding.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "FrozenHashTable.h"
+#include "HashFunctions.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    /* Purpose: Runs fn(begin, end) over [0, count) split evenly across threads.
+     */
+    template <typename Fn>
+    void parallelRanges(const size_t count, const size_t threads, Fn fn) {
+        if (threads <= 1 || count < 4096) {
+            fn(size_t{0}, count);
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back(fn, count * t / threads, count * (t + 1) / threads);
+        }
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    /* Purpose: Rounds a byte count up to a multiple of 8.
+     */
+    constexpr size_t align8(const size_t bytes) {
+        return (bytes + 7) & ~size_t{7};
+    }
+
+    /* Purpose: Takes one image section off the front of the bytes that remain.
+     * Parameters:
+     *    remaining – bytes of the image not yet accounted for
+     *    count – elements in the section
+     *    elementSize – bytes per element
+     *    pad – whether the section is padded to a multiple of 8 bytes
+     * Returns:
+     *    false, leaving remaining alone, if the section does not fit
+     * Behavior:
+     *    Compares by division, so no count read from a corrupt header can
+     *    overflow into a plausible length.
+     */
+    bool takeSection(size_t& remaining, const uint64_t count, const size_t elementSize, const bool pad) {
+        if (count > remaining / elementSize) return false;
+        const size_t bytes = pad ? align8(count * elementSize) : count * elementSize;
+        if (bytes > remaining) return false;
+        remaining -= bytes;
+        return true;
+    }
+}
+
+/* Purpose: Constructs an empty frozen table.
+ */
+FrozenHashTable::FrozenHashTable() : FrozenHashTable(std::vector<std::pair<std::string, int>>{}) {
+}
+
+/* Purpose: Builds a frozen table from key-value pairs.
+ * Parameters:
+ *    entries – distinct keys and their values
+ *    threads – worker threads for hashing and packing (0 = hardware concurrency)
+ * Throws:
+ *    invalid_argument if entries contains a duplicate key
+ *    runtime_error if no seed yields a pilot for every bucket
+ * Behavior:
+ *    Hashes every key in parallel, then assigns pilots bucket by bucket,
+ *    largest buckets first, choosing for each the smallest pilot that sends
+ *    all of its keys to free slots. Pilots address size / LOAD_FACTOR slots,
+ *    so even the last buckets have about 2% of the slots to choose from;
+ *    keys that land past size are then remapped, in PTHash's manner, to the
+ *    free slots below it, keeping the stored table minimal. If some bucket
+ *    needs too many attempts, or two distinct keys share a hash, the build
+ *    restarts with a new seed. Finally keys and values are copied into the
+ *    image in slot order, again in parallel.
+ */
+FrozenHashTable::FrozenHashTable(const std::vector<std::pair<std::string, int>>& entries, size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    const uint64_t n = entries.size();
+    const uint64_t slotCount = slotCountFor(n);
+    const uint64_t bucketCount = std::max<uint64_t>(1, static_cast<uint64_t>(n / KEYS_PER_BUCKET) + 1);
+    std::vector<uint64_t> hashes(n);
+    std::vector<uint32_t> bucketPilots(bucketCount);
+    std::vector<uint64_t> slotOf(n);
+    std::vector<bool> taken;
+    uint64_t seed = 0;
+
+    for (bool placed = false; !placed; seed++) {
+        if (seed == MAX_SEEDS) throw std::runtime_error("FrozenHashTable: no pilot found for every bucket");
+
+        parallelRanges(n, threads, [&](const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; i++) hashes[i] = hash(entries[i].first, seed);
+        });
+
+        // group key indices by bucket with a counting sort
+        std::vector<uint64_t> bucketStart(bucketCount + 1, 0);
+        for (uint64_t i = 0; i < n; i++) bucketStart[(hashes[i] >> 32) % bucketCount + 1]++;
+        for (uint64_t b = 0; b < bucketCount; b++) bucketStart[b + 1] += bucketStart[b];
+        std::vector<uint64_t> members(n);
+        std::vector<uint64_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+        for (uint64_t i = 0; i < n; i++) members[fill[(hashes[i] >> 32) % bucketCount]++] = i;
+
+        std::vector<uint64_t> order(bucketCount);
+        for (uint64_t b = 0; b < bucketCount; b++) order[b] = b;
+        std::stable_sort(order.begin(), order.end(), [&](const uint64_t a, const uint64_t b) {
+            return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+        });
+
+        taken.assign(slotCount, false);
+        std::vector<uint64_t> candidate;
+        placed = true;
+
+        for (const uint64_t b : order) {
+            const uint64_t first = bucketStart[b];
+            const uint64_t count = bucketStart[b + 1] - first;
+            if (count == 0) break; // buckets are sorted by size, so the rest are empty too
+
+            // keys with identical hashes can never be separated by a pilot; equal keys are an error,
+            // distinct ones need another seed
+            bool separable = true;
+            for (uint64_t j = 0; j < count && separable; j++) {
+                for (uint64_t k = j + 1; k < count && separable; k++) {
+                    const uint64_t a = members[first + j];
+                    const uint64_t c = members[first + k];
+                    if (hashes[a] != hashes[c]) continue;
+                    if (entries[a].first == entries[c].first) {
+                        throw std::invalid_argument("FrozenHashTable: duplicate key " + entries[a].first);
+                    }
+                    separable = false;
+                }
+            }
+
+            bool found = false;
+            for (uint32_t pilot = 0; pilot < MAX_PILOT && separable && !found; pilot++) {
+                candidate.clear();
+                found = true;
+                for (uint64_t k = 0; k < count && found; k++) {
+                    const uint64_t slot = slotFor(hashes[members[first + k]], pilot, slotCount);
+                    found = !taken[slot] && std::find(candidate.begin(), candidate.end(), slot) == candidate.end();
+                    candidate.push_back(slot);
+                }
+                if (found) {
+                    bucketPilots[b] = pilot;
+                    for (uint64_t k = 0; k < count; k++) {
+                        taken[candidate[k]] = true;
+                        slotOf[members[first + k]] = candidate[k];
+                    }
+                }
+            }
+            if (!found) {
+                placed = false;
+                break;
+            }
+        }
+    }
+    seed--; // the loop increments past the seed that worked
+
+    // send each key placed past n to a free slot below n; there are exactly as many of each
+    std::vector<uint64_t> remapped(slotCount - n, 0);
+    for (uint64_t high = n, low = 0; high < slotCount; high++) {
+        if (!taken[high]) continue;
+        while (taken[low]) low++;
+        taken[low] = true;
+        remapped[high - n] = low;
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        if (slotOf[i] >= n) slotOf[i] = remapped[slotOf[i] - n];
+    }
+
+    // lay keys out in slot order
+    std::vector<uint64_t> offsetsBySlot(n + 1, 0);
+    for (uint64_t i = 0; i < n; i++) offsetsBySlot[slotOf[i] + 1] = entries[i].first.size();
+    for (uint64_t s = 0; s < n; s++) offsetsBySlot[s + 1] += offsetsBySlot[s];
+    const uint64_t keyBytes = offsetsBySlot[n];
+
+    owned.assign(imageSize(n, slotCount, bucketCount, keyBytes), 0);
+    Header* newHeader = reinterpret_cast<Header*>(owned.data());
+    std::memcpy(newHeader->magic, MAGIC, sizeof(MAGIC));
+    newHeader->size = n;
+    newHeader->slotCount = slotCount;
+    newHeader->bucketCount = bucketCount;
+    newHeader->seed = seed;
+    newHeader->keyBytes = keyBytes;
+    attach(owned.data(), owned.size());
+
+    std::memcpy(const_cast<uint32_t*>(pilots), bucketPilots.data(), bucketCount * sizeof(uint32_t));
+    if (!remapped.empty()) { // an empty vector's data() may be null, which memcpy must not get
+        std::memcpy(const_cast<uint64_t*>(remap), remapped.data(), remapped.size() * sizeof(uint64_t));
+    }
+    std::memcpy(const_cast<uint64_t*>(keyOffsets), offsetsBySlot.data(), (n + 1) * sizeof(uint64_t));
+    parallelRanges(n, threads, [&](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const uint64_t slot = slotOf[i];
+            const_cast<int32_t*>(values)[slot] = entries[i].second;
+            std::memcpy(const_cast<char*>(keyBlob) + keyOffsets[slot], entries[i].first.data(),
+                        entries[i].first.size());
+        }
+    });
+}
+
+/* Purpose: Move constructor; takes over the image or the mapping.
+ */
+FrozenHashTable::FrozenHashTable(FrozenHashTable&& other) noexcept {
+    *this = std::move(other);
+}
+
+/* Purpose: Move assignment; releases this table's image first.
+ */
+FrozenHashTable& FrozenHashTable::operator=(FrozenHashTable&& other) noexcept {
+    if (this != &other) {
+        release();
+        owned = std::move(other.owned); // the buffer, and so every section pointer, stays in place
+        mapping = std::exchange(other.mapping, nullptr);
+        mappingLength = std::exchange(other.mappingLength, 0);
+        header = std::exchange(other.header, nullptr);
+        pilots = std::exchange(other.pilots, nullptr);
+        remap = std::exchange(other.remap, nullptr);
+        keyOffsets = std::exchange(other.keyOffsets, nullptr);
+        values = std::exchange(other.values, nullptr);
+        keyBlob = std::exchange(other.keyBlob, nullptr);
+    }
+    return *this;
+}
+
+/* Purpose: Destructor; unmaps a mapped image.
+ */
+FrozenHashTable::~FrozenHashTable() {
+    release();
+}
+
+/* Purpose: Releases the mapping, if any.
+ */
+void FrozenHashTable::release() {
+#ifdef __linux__
+    if (mapping != nullptr) munmap(mapping, mappingLength);
+#endif
+    mapping = nullptr;
+    mappingLength = 0;
+}
+
+/* Purpose: Computes a key's seeded hash.
+ * Parameters:
+ *    key – key to hash
+ *    seed – build seed
+ * Returns:
+ *    uint64_t – high half picks the bucket, the whole hash picks the slot
+ */
+uint64_t FrozenHashTable::hash(const std::string_view key, const uint64_t seed) {
+    return mix64(fnv1a64(key) ^ (seed * 0x9e3779b97f4a7c15ULL));
+}
+
+/* Purpose: Maps a key's hash and its bucket's pilot to a slot.
+ * Returns:
+ *    size_t – slot in [0, size)
+ */
+size_t FrozenHashTable::slotFor(const uint64_t h, const uint32_t pilot, const uint64_t size) {
+    return (h ^ mix64(pilot + 0x9e3779b97f4a7c15ULL)) % size;
+}
+
+/* Purpose: Returns how many slots the pilots address for a number of keys.
+ * Returns:
+ *    uint64_t – size / LOAD_FACTOR rounded up, and 0 for an empty table
+ */
+uint64_t FrozenHashTable::slotCountFor(const uint64_t size) {
+    if (size == 0) return 0;
+    return std::max(size + 1, static_cast<uint64_t>(std::ceil(static_cast<double>(size) / LOAD_FACTOR)));
+}
+
+/* Purpose: Returns the length of an image.
+ * Parameters:
+ *    size – number of keys
+ *    slotCount – slots the pilots address
+ *    bucketCount – number of pilot buckets
+ *    keyBytes – total key length
+ */
+size_t FrozenHashTable::imageSize(const uint64_t size, const uint64_t slotCount, const uint64_t bucketCount,
+                                  const uint64_t keyBytes) {
+    return align8(sizeof(Header)) + align8(bucketCount * sizeof(uint32_t)) + (slotCount - size) * sizeof(uint64_t) +
+           (size + 1) * sizeof(uint64_t) + align8(size * sizeof(int32_t)) + keyBytes;
+}
+
+/* Purpose: Points the section pointers into an image.
+ * Parameters:
+ *    image – start of the image (8-byte aligned)
+ *    length – length of the image
+ * Throws:
+ *    runtime_error if the image is truncated or not a frozen table
+ * Behavior:
+ *    Checks that the sections the header describes exactly fill length,
+ *    one section at a time so that no header field can overflow the sum.
+ *    Their contents are checked by checkSections().
+ */
+void FrozenHashTable::attach(const char* image, const size_t length) {
+    if (length < sizeof(Header)) throw std::runtime_error("FrozenHashTable: image too short");
+
+    header = reinterpret_cast<const Header*>(image);
+    size_t remaining = length - align8(sizeof(Header));
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->bucketCount == 0 ||
+        header->slotCount < header->size ||
+        !takeSection(remaining, header->bucketCount, sizeof(uint32_t), true) ||
+        !takeSection(remaining, header->slotCount - header->size, sizeof(uint64_t), false) ||
+        !takeSection(remaining, header->size, sizeof(uint64_t), false) ||
+        !takeSection(remaining, 1, sizeof(uint64_t), false) || // keyOffsets has size + 1 entries
+        !takeSection(remaining, header->size, sizeof(int32_t), true) ||
+        !takeSection(remaining, header->keyBytes, 1, false) || remaining != 0) {
+        throw std::runtime_error("FrozenHashTable: not a frozen hash table image");
+    }
+
+    const char* cursor = image + align8(sizeof(Header));
+    pilots = reinterpret_cast<const uint32_t*>(cursor);
+    cursor += align8(header->bucketCount * sizeof(uint32_t));
+    remap = reinterpret_cast<const uint64_t*>(cursor);
+    cursor += (header->slotCount - header->size) * sizeof(uint64_t);
+    keyOffsets = reinterpret_cast<const uint64_t*>(cursor);
+    cursor += (header->size + 1) * sizeof(uint64_t);
+    values = reinterpret_cast<const int32_t*>(cursor);
+    cursor += align8(header->size * sizeof(int32_t));
+    keyBlob = cursor;
+}
+
+/* Purpose: Checks the sections of an image read from outside.
+ * Throws:
+ *    runtime_error if a key offset or a remapped slot points outside the image
+ * Behavior:
+ *    Key offsets must start at 0, never decrease and end at keyBytes, and
+ *    every remapped slot must be below size, so keyAt() and find() stay in
+ *    bounds. Pilots need no check: slotFor() reduces any pilot to a slot.
+ */
+void FrozenHashTable::checkSections() const {
+    const uint64_t size = header->size;
+    bool valid = keyOffsets[0] == 0 && keyOffsets[size] == header->keyBytes;
+    for (uint64_t s = 0; s < size && valid; s++) {
+        valid = keyOffsets[s] <= keyOffsets[s + 1];
+    }
+    for (uint64_t i = 0; i < header->slotCount - size && valid; i++) {
+        valid = remap[i] < size;
+    }
+    if (!valid) throw std::runtime_error("FrozenHashTable: corrupt frozen hash table image");
+}
+
+/* Purpose: Returns the key stored in a slot.
+ */
+std::string_view FrozenHashTable::keyAt(const size_t slot) const {
+    return {keyBlob + keyOffsets[slot], keyOffsets[slot + 1] - keyOffsets[slot]};
+}
+
+/* Purpose: Finds the slot holding a key.
+ * Parameters:
+ *    key – key to search
+ * Returns:
+ *    the key's slot, or nullopt if key is not in the table
+ * Behavior:
+ *    One hash, one pilot read, one key comparison; never probes. About 2%
+ *    of keys also read their slot from the remap section.
+ */
+std::optional<size_t> FrozenHashTable::find(const std::string_view key) const {
+    if (header->size == 0) return std::nullopt;
+
+    const uint64_t h = hash(key, header->seed);
+    size_t slot = slotFor(h, pilots[(h >> 32) % header->bucketCount], header->slotCount);
+    if (slot >= header->size) slot = remap[slot - header->size];
+    if (keyAt(slot) != key) return std::nullopt;
+    return slot;
+}
+
+/* Purpose: Checks whether the table contains a key.
+ * Parameters:
+ *    key – key to search
+ * Returns:
+ *    true if key exists, false otherwise
+ */
+bool FrozenHashTable::contains(const std::string_view key) const {
+    return find(key).has_value();
+}
+
+/* Purpose: Retrieves the value associated with a key.
+ * Parameters:
+ *    key – key to lookup
+ * Returns:
+ *    optional<int> containing value if key exists, nullopt otherwise
+ */
+std::optional<int> FrozenHashTable::get(const std::string_view key) const {
+    const std::optional<size_t> slot = find(key);
+    if (!slot) return std::nullopt;
+    return values[*slot];
+}
+
+/* Purpose: Returns all keys in slot order.
+ * Returns:
+ *    vector<string> containing every key
+ */
+std::vector<std::string> FrozenHashTable::keys() const {
+    std::vector<std::string> keys;
+    keys.reserve(header->size);
+
+    for (size_t s = 0; s < header->size; s++) {
+        keys.emplace_back(keyAt(s));
+    }
+
+    return keys;
+}
+
+/* Purpose: Returns number of key-value pairs in the table.
+ * Returns:
+ *    size_t – number of entries, which is also the number of slots
+ */
+size_t FrozenHashTable::size() const {
+    return header->size;
+}
+
+/* Purpose: Returns the size of the table's image.
+ * Returns:
+ *    size_t – bytes used by the header, pilots, offsets, values and keys
+ */
+size_t FrozenHashTable::bytes() const {
+    return imageSize(header->size, header->slotCount, header->bucketCount, header->keyBytes);
+}
+
+/* Purpose: Reports whether the image is memory-mapped from a file.
+ * Returns:
+ *    true if created by map() with mmap available, false otherwise
+ */
+bool FrozenHashTable::isMapped() const {
+    return mapping != nullptr;
+}
+
+/* Purpose: Writes the table's image to a file.
+ * Parameters:
+ *    path – file to create or overwrite
+ * Throws:
+ *    runtime_error if the file cannot be written
+ */
+void FrozenHashTable::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(header), static_cast<std::streamsize>(bytes()));
+    if (!out) throw std::runtime_error("FrozenHashTable: cannot write " + path);
+}
+
+/* Purpose: Reads a saved table into memory.
+ * Parameters:
+ *    path – file written by save()
+ * Returns:
+ *    FrozenHashTable – owning a copy of the image
+ * Throws:
+ *    runtime_error if the file cannot be read or is not a frozen table
+ */
+FrozenHashTable FrozenHashTable::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("FrozenHashTable: cannot read " + path);
+
+    FrozenHashTable table;
+    table.owned.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(table.owned.data(), static_cast<std::streamsize>(table.owned.size()));
+    if (!in) throw std::runtime_error("FrozenHashTable: cannot read " + path);
+
+    table.attach(table.owned.data(), table.owned.size());
+    table.checkSections();
+    return table;
+}
+
+/* Purpose: Memory-maps a saved table.
+ * Parameters:
+ *    path – file written by save()
+ * Returns:
+ *    FrozenHashTable – reading directly from the page cache; pages are
+ *    loaded on first touch and shared between processes mapping the file
+ * Throws:
+ *    runtime_error if the file cannot be mapped or is not a frozen table
+ * Behavior:
+ *    Falls back to load() where mmap is not available.
+ */
+FrozenHashTable FrozenHashTable::map(const std::string& path) {
+#ifdef __linux__
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("FrozenHashTable: cannot open " + path);
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("FrozenHashTable: cannot stat " + path);
+    }
+    void* p = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) throw std::runtime_error("FrozenHashTable: cannot map " + path);
+
+    FrozenHashTable table;
+    table.owned.clear();
+    table.owned.shrink_to_fit();
+    table.mapping = p;
+    table.mappingLength = static_cast<size_t>(info.st_size);
+    table.attach(static_cast<const char*>(p), table.mappingLength); // on throw, table's destructor unmaps
+    table.checkSections();
+    return table;
+#else
+    return load(path);
+#endif
+}
+
+/* Purpose: Prints the table to an output stream.
+ * Parameters:
+ *    os – output stream (e.g., cout)
+ */
+std::ostream& operator<<(std::ostream& os, const FrozenHashTable& table) {
+    os << table.printMe();
+    return os;
+}
+
+/* Purpose: Returns a string representation of the table.
+ * Returns:
+ *    string – one line per slot
+ */
+std::string FrozenHashTable::printMe() const {
+    std::ostringstream out;
+
+    for (size_t s = 0; s < header->size; s++) {
+        out << "Slot " << s << ": <" << keyAt(s) << ", " << values[s] << ">\n";
+    }
+
+    return out.str();
+}
@@ -0,0 +1,91 @@
+/*
+ * FrozenHashTable.h
+ */
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class FrozenHashTable {
+    private:
+        // fixed-size prefix of the image; every section after it is 8-byte aligned
+        struct Header {
+            char magic[8]; // "FRZNHT2" plus terminator
+            uint64_t size; // number of keys, also the number of stored slots
+            uint64_t slotCount; // slots the pilots address; those from size on are remapped below size
+            uint64_t bucketCount; // number of pilot buckets
+            uint64_t seed; // hash seed chosen at build time
+            uint64_t keyBytes; // length of the packed key blob
+        };
+
+        static constexpr char MAGIC[8] = "FRZNHT2";
+        static constexpr double KEYS_PER_BUCKET = 4.0;
+        static constexpr double LOAD_FACTOR = 0.98; // keys per addressed slot, so the last buckets still find room
+        static constexpr uint32_t MAX_PILOT = 1u << 24; // pilot search limit before reseeding
+        static constexpr uint64_t MAX_SEEDS = 16; // seeds tried before the build gives up
+
+        std::vector<char> owned; // the image when built or loaded into memory
+        void* mapping = nullptr; // the image when mapped from a file
+        size_t mappingLength = 0; // length of mapping
+        const Header* header = nullptr; // start of the image
+        const uint32_t* pilots = nullptr; // per-bucket displacement (pilot) values
+        const uint64_t* remap = nullptr; // slot size + i is stored in slot remap[i]
+        const uint64_t* keyOffsets = nullptr; // slot i's key spans [keyOffsets[i], keyOffsets[i + 1])
+        const int32_t* values = nullptr; // slot i's value
+        const char* keyBlob = nullptr; // every key, packed back to back in slot order
+
+        [[nodiscard]] static uint64_t hash(std::string_view key, uint64_t seed);
+
+        [[nodiscard]] static size_t slotFor(uint64_t h, uint32_t pilot, uint64_t size);
+
+        [[nodiscard]] static uint64_t slotCountFor(uint64_t size);
+
+        [[nodiscard]] static size_t imageSize(uint64_t size, uint64_t slotCount, uint64_t bucketCount,
+                                              uint64_t keyBytes);
+
+        void attach(const char* image, size_t length);
+
+        void checkSections() const;
+
+        void release();
+
+        [[nodiscard]] std::string_view keyAt(size_t slot) const;
+
+        [[nodiscard]] std::optional<size_t> find(std::string_view key) const;
+
+    public:
+        FrozenHashTable(); // empty table
+
+        FrozenHashTable(const std::vector<std::pair<std::string, int>>& entries, size_t threads = 0);
+
+        FrozenHashTable(const FrozenHashTable&) = delete;
+        FrozenHashTable& operator=(const FrozenHashTable&) = delete;
+        FrozenHashTable(FrozenHashTable&& other) noexcept;
+        FrozenHashTable& operator=(FrozenHashTable&& other) noexcept;
+        ~FrozenHashTable();
+
+        [[nodiscard]] bool contains(std::string_view key) const;
+
+        [[nodiscard]] std::optional<int> get(std::string_view key) const;
+
+        [[nodiscard]] std::vector<std::string> keys() const;
+
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] size_t bytes() const;
+
+        [[nodiscard]] bool isMapped() const;
+
+        void save(const std::string& path) const;
+
+        [[nodiscard]] static FrozenHashTable load(const std::string& path);
+
+        [[nodiscard]] static FrozenHashTable map(const std::string& path);
+
+        friend std::ostream& operator<<(std::ostream& os, const FrozenHashTable& hashTable);
+
+        [[nodiscard]] std::string printMe() const;
+};
@@ -0,0 +1,40 @@
+/*
+ * HashFunctions.h
+ */
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+/* Purpose: Computes a 64-bit FNV-1a hash of a key.
+ * Parameters:
+ *    key – bytes to hash
+ * Returns:
+ *    uint64_t – well-mixed hash; callers take low bits for an index and
+ *    high bits for a tag
+ */
+constexpr uint64_t fnv1a64(const std::string_view key) {
+    uint64_t h = 14695981039346656037ULL;
+    for (const char c : key) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* Purpose: Finalizes a hash so every output bit depends on every input bit.
+ * Parameters:
+ *    h – hash to mix (MurmurHash3's fmix64 finalizer)
+ * Returns:
+ *    uint64_t – mixed hash
+ * Behavior:
+ *    FNV-1a leaves its high bits poorly mixed for short keys; run this over
+ *    its result before using the high bits as a second hash or a tag.
+ */
+constexpr uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
@@ -11,42 +11,384 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <optional>
 #include <random>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
+#include "FrozenHashTable.h"
 #include "HashTable.h"
+#include "KeyHash.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+
+/* Purpose: Asks the CPU to start loading the cache line holding address.
+ */
+void prefetchRead(const void* address) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    __builtin_prefetch(address, 0, 3);
+#endif
+}
+
+// memory resource that only adds up the bytes requested from it
+class ByteCounter : public std::pmr::memory_resource {
+    public:
+        size_t bytes = 0;
+
+    private:
+        void* do_allocate(const size_t size, const size_t alignment) override {
+            bytes += size;
+            return std::pmr::new_delete_resource()->allocate(size, alignment);
+        }
+
+        void do_deallocate(void* p, const size_t size, const size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+        }
+
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+};
+
+/* Purpose: Returns the size of the block allocate_shared<T> takes for an
+ *          empty T, i.e. the object plus its reference counts.
+ * Behavior:
+ *    The layout is up to the standard library, so it is measured once.
+ */
+template <typename T>
+size_t sharedBlockBytes() {
+    static const size_t bytes = [] {
+        ByteCounter counter;
+        std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(&counter)).reset();
+        return counter.bytes;
+    }();
+    return bytes;
+}
+
+// fixed start of an exportDelta() image; all fields are in host byte order
+struct DeltaHeader {
+    char magic[4];
+    uint32_t full; // 1 if the runs cover every bucket
+    uint64_t sinceEpoch; // the image holds every block written after this epoch
+    uint64_t throughEpoch; // epoch the exporting table was in
+    uint64_t capacity;
+    uint64_t hashCheck; // hash() of DELTA_HASH_PROBE in the exporting process
+    uint64_t runCount; // runs of consecutive buckets that follow
+};
+
+constexpr char DELTA_MAGIC[4] = {'H', 'T', 'D', '1'};
+constexpr std::string_view DELTA_HASH_PROBE = "HashTable delta";
+
+// tag byte that starts each bucket of a run
+enum DeltaTag : uint8_t {DELTA_ESS, DELTA_EAR, DELTA_NORMAL, DELTA_NORMAL_TTL};
+
+/* Purpose: Appends the bytes of a trivially copyable value to out.
+ */
+template <typename T>
+void appendRaw(std::string& out, const T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// bounds-checked cursor over a delta image
+class DeltaReader {
+    public:
+        explicit DeltaReader(const std::string_view data) : data(data) {
+        }
+
+        std::string_view take(const size_t bytes) {
+            if (bytes > data.size() - pos) throw std::runtime_error("HashTable: truncated delta");
+            const std::string_view taken = data.substr(pos, bytes);
+            pos += bytes;
+            return taken;
+        }
+
+        template <typename T>
+        T read() {
+            T value;
+            std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+            return value;
+        }
+
+        [[nodiscard]] bool atEnd() const {
+            return pos == data.size();
+        }
+
+    private:
+        std::string_view data;
+        size_t pos = 0;
+};
+
+/* Purpose: Returns the probe offsets of a table with no buckets.
+ * Behavior:
+ *    One empty vector shared by every moved-from table, so a move never
+ *    allocates and probe loops over it end at once.
+ */
+const std::shared_ptr<const std::pmr::vector<size_t>>& noOffsets() {
+    static const std::shared_ptr<const std::pmr::vector<size_t>> empty =
+        std::make_shared<const std::pmr::vector<size_t>>();
+    return empty;
+}
+
+} // namespace
 
 /* Purpose: Constructs a hash table with initial capacity.
  * Parameters:
  *    initCapacity – number of buckets to initially create (defaults to 8)
+ *    alloc – allocator for the bucket array, offsets and keys (defaults to
+ *            the default memory resource)
  * Behavior:
  *    Initializes table vector, sets size to 0, and generates initial offsets
- *    for pseudo-random probing.
+ *    for pseudo-random probing. Every allocation the table makes, including
+ *    key storage, goes through alloc's memory resource.
+ */
+HashTable::HashTable(const size_t initCapacity, const allocator_type& alloc)
+    : m_capacity(initCapacity), m_size(0), pages(alloc), blockEpochs(alloc) {
+    allocatePages();
+    generateOffsets(m_capacity); // same deterministic shuffle resize() uses for this capacity
+}
+
+/* Purpose: Constructs an empty hash table of default capacity using an allocator.
+ * Parameters:
+ *    alloc – allocator for the bucket array, offsets and keys
+ * Behavior:
+ *    Lets HashTable be used as an element of pmr containers.
+ */
+HashTable::HashTable(const allocator_type& alloc) : HashTable(DEFAULT_INITIAL_CAPACITY, alloc) {
+}
+
+/* Purpose: Copies a hash table.
+ * Parameters:
+ *    other – table to copy
+ * Behavior:
+ *    As for any pmr container, the copy uses the default memory resource
+ *    rather than other's, so every page is copied into it: a shared page
+ *    would still live in other's resource, which may be an arena that is
+ *    released first. Only snapshot() shares pages.
+ */
+HashTable::HashTable(const HashTable& other) : HashTable(other, allocator_type()) {
+}
+
+/* Purpose: Copies a hash table into a different memory resource.
+ * Parameters:
+ *    other – table to copy
+ *    alloc – allocator for the new table
+ * Behavior:
+ *    Copies every page into alloc's resource, since shared pages would
+ *    keep using the other table's resource.
  */
-HashTable::HashTable(const size_t initCapacity) : m_capacity(initCapacity), m_size(0) {
-    table.resize(m_capacity);
-    generateOffsets();
+HashTable::HashTable(const HashTable& other, const allocator_type& alloc)
+    : m_capacity(other.m_capacity), m_size(other.m_size), pages(alloc), blockEpochs(other.blockEpochs, alloc),
+      offsets(std::allocate_shared<const std::pmr::vector<size_t>>(alloc, *other.offsets)),
+      m_tombstones(other.m_tombstones), m_maxEntries(other.m_maxEntries), m_clockHand(other.m_clockHand),
+      m_stats(other.m_stats), m_epoch(other.m_epoch), m_replicaEpoch(other.m_replicaEpoch) {
+    for (const std::shared_ptr<BucketPage>& page : other.pages) {
+        pages.push_back(std::allocate_shared<BucketPage>(std::pmr::polymorphic_allocator<BucketPage>(alloc), *page));
+    }
+    if (other.filter) enableFilter(other.m_filterBitsPerKey);
+}
+
+/* Purpose: Moves a hash table.
+ * Parameters:
+ *    other – table to move from
+ * Behavior:
+ *    Takes over other's pages, offsets and filter without allocating.
+ *    other is left an empty table with capacity 0: lookups find nothing,
+ *    and the first insert gives it the default capacity.
+ */
+HashTable::HashTable(HashTable&& other) noexcept
+    : m_capacity(std::exchange(other.m_capacity, 0)), m_size(std::exchange(other.m_size, 0)),
+      pages(std::move(other.pages)), blockEpochs(std::move(other.blockEpochs)),
+      offsets(std::exchange(other.offsets, noOffsets())), filter(std::move(other.filter)),
+      m_filterBitsPerKey(std::exchange(other.m_filterBitsPerKey, 0)), m_tombstones(std::exchange(other.m_tombstones, 0)),
+      m_maxEntries(std::exchange(other.m_maxEntries, 0)), m_clockHand(std::exchange(other.m_clockHand, 0)),
+      m_stats(other.m_stats), m_epoch(other.m_epoch), m_replicaEpoch(other.m_replicaEpoch),
+      m_rehashOnResize(other.m_rehashOnResize) {
+    other.filter.reset();
+}
+
+/* Purpose: Move-assigns a hash table.
+ * Parameters:
+ *    other – table to move from
+ * Returns:
+ *    reference to this table
+ * Behavior:
+ *    Unlike pmr containers, the table takes over other's memory resource
+ *    along with its pages, so the move never allocates or copies a key.
+ */
+HashTable& HashTable::operator=(HashTable&& other) noexcept {
+    if (this != &other) {
+        std::destroy_at(this);
+        std::construct_at(this, std::move(other));
+    }
+    return *this;
+}
+
+/* Purpose: Replaces the contents with a copy of another table.
+ * Parameters:
+ *    other – table to copy
+ * Returns:
+ *    reference to this table
+ * Behavior:
+ *    The table keeps its own memory resource and copies every page of
+ *    other into it. Nothing changes if the copy throws.
+ */
+HashTable& HashTable::operator=(const HashTable& other) {
+    if (this != &other) {
+        *this = HashTable(other, getAllocator());
+    }
+    return *this;
+}
+
+/* Purpose: Exchanges the contents, and memory resources, of two tables.
+ * Parameters:
+ *    other – table to swap with
+ */
+void HashTable::swap(HashTable& other) noexcept {
+    HashTable moved(std::move(other));
+    other = std::move(*this);
+    *this = std::move(moved);
+}
+
+/* Purpose: Removes every entry, keeping the capacity.
+ * Behavior:
+ *    Takes O(capacity / PAGE_BUCKETS) time besides freeing the old
+ *    entries: every full page is pointed at one shared page of ESS buckets,
+ *    which the first write to each page copies as for a snapshot. Cache
+ *    counters and the filter's density are kept. A moved-from table gets
+ *    the default capacity back.
+ */
+void HashTable::clear() {
+    if (m_capacity == 0) {
+        m_capacity = DEFAULT_INITIAL_CAPACITY;
+        generateOffsets(m_capacity);
+    }
+    const std::pmr::polymorphic_allocator<BucketPage> pageAlloc(pages.get_allocator().resource());
+    const size_t pageCount = (m_capacity + PAGE_BUCKETS - 1) / PAGE_BUCKETS;
+    std::shared_ptr<BucketPage> emptyPage;
+
+    pages.resize(pageCount);
+    for (size_t p = 0; p < pageCount; p++) {
+        const size_t buckets = std::min(PAGE_BUCKETS, m_capacity - p * PAGE_BUCKETS);
+        if (buckets < PAGE_BUCKETS) {
+            pages[p] = std::allocate_shared<BucketPage>(pageAlloc, buckets);
+        } else {
+            if (!emptyPage) emptyPage = std::allocate_shared<BucketPage>(pageAlloc, PAGE_BUCKETS);
+            pages[p] = emptyPage;
+        }
+    }
+    blockEpochs.assign((m_capacity + DIRTY_BUCKETS - 1) / DIRTY_BUCKETS, m_epoch);
+    m_size = 0;
+    m_tombstones = 0;
+    m_clockHand = 0;
+    if (filter) filter->clear();
+}
+
+/* Purpose: Allocates fresh ESS pages for the current capacity.
+ * Behavior:
+ *    Every page holds PAGE_BUCKETS buckets, except that the last page holds
+ *    only the buckets left over, so no bucket lies past m_capacity. Every
+ *    block is marked as written in the current epoch, since the layout of
+ *    the whole table changed.
+ */
+void HashTable::allocatePages() {
+    const std::pmr::polymorphic_allocator<BucketPage> pageAlloc(pages.get_allocator().resource());
+    const size_t pageCount = (m_capacity + PAGE_BUCKETS - 1) / PAGE_BUCKETS;
+
+    pages.clear();
+    pages.reserve(pageCount);
+    for (size_t p = 0; p < pageCount; p++) {
+        pages.push_back(std::allocate_shared<BucketPage>(pageAlloc, std::min(PAGE_BUCKETS, m_capacity - p * PAGE_BUCKETS)));
+    }
+    blockEpochs.assign((m_capacity + DIRTY_BUCKETS - 1) / DIRTY_BUCKETS, m_epoch);
+}
+
+/* Purpose: Returns a bucket for reading.
+ * Parameters:
+ *    index – bucket index
+ * Returns:
+ *    const reference to the bucket, which may be shared with a snapshot
+ */
+const HashTableBucket& HashTable::bucketAt(const size_t index) const {
+    return (*pages[index >> PAGE_SHIFT])[index & (PAGE_BUCKETS - 1)];
+}
+
+/* Purpose: Returns a bucket for writing.
+ * Parameters:
+ *    index – bucket index
+ * Returns:
+ *    reference to the bucket
+ * Behavior:
+ *    If the bucket's page is shared with a snapshot, the page is copied
+ *    first, so the snapshot keeps seeing the old contents. Stamps the
+ *    bucket's block with the current epoch for exportDelta().
+ */
+HashTableBucket& HashTable::mutableBucketAt(const size_t index) {
+    blockEpochs[index >> DIRTY_SHIFT] = m_epoch;
+    std::shared_ptr<BucketPage>& page = pages[index >> PAGE_SHIFT];
+    if (page.use_count() > 1) {
+        page = std::allocate_shared<BucketPage>(std::pmr::polymorphic_allocator<BucketPage>(page->get_allocator()), *page);
+    }
+    return (*page)[index & (PAGE_BUCKETS - 1)];
 }
 
 /* Purpose: Resizes the hash table when load factor exceeds threshold.
  * Behavior:
- *    Doubles the table capacity, rehashes all existing key-value pairs,
- *    and regenerates offsets.
+ *    Doubles the table capacity (a moved-from table gets the default
+ *    capacity), rehashes all existing key-value pairs, and regenerates
+ *    offsets. The old bucket array is moved out rather than
+ *    copied, so only one extra array is alive while rehashing.
  */
 void HashTable::resize() {
-    std::vector<HashTableBucket> oldTable = table;
-    m_capacity *= 2;
-    table.clear();
-    table.resize(m_capacity);
+    rebuild(m_capacity > 0 ? m_capacity * 2 : DEFAULT_INITIAL_CAPACITY);
+}
+
+/* Purpose: Rehashes every live entry into a fresh table.
+ * Parameters:
+ *    newCapacity – capacity of the new table
+ * Behavior:
+ *    Clears all EAR buckets and drops expired entries. Buckets are moved
+ *    whole, so TTLs and access bits survive, and each is placed by its
+ *    stored hash, so no key is hashed again. Keys in pages a snapshot
+ *    still shares are copied instead of moved.
+ */
+void HashTable::rebuild(const size_t newCapacity) {
+    const std::pmr::vector<std::shared_ptr<BucketPage>> oldPages = std::move(pages);
+    m_capacity = newCapacity;
+    pages = std::pmr::vector<std::shared_ptr<BucketPage>>(oldPages.get_allocator());
+    allocatePages();
     m_size = 0;
+    m_tombstones = 0;
+    m_clockHand = 0;
 
     generateOffsets(m_capacity); // deterministic shuffle for new table
+    if (filter) filter = BloomFilter(m_capacity / 2, m_filterBitsPerKey, getAllocator()); // refilled below
 
-    for (HashTableBucket& bucket : oldTable) {
-        if (!bucket.isEmpty()) {
-            insert(bucket.getKey(), bucket.getValue());
+    const auto now = std::chrono::steady_clock::now();
+    for (const std::shared_ptr<BucketPage>& page : oldPages) {
+        const bool owned = page.use_count() == 1; // no snapshot reads it, so its keys can be moved
+        for (HashTableBucket& bucket : *page) {
+            if (bucket.isEmpty()) continue;
+            if (bucket.isExpired(now)) {
+                m_stats.expirations++;
+                continue;
+            }
+            const uint64_t keyHash = m_rehashOnResize ? hash(bucket.getKeyView()) : bucket.getHash();
+            HashTableBucket& target = mutableBucketAt(probe(bucket.getKeyView(), keyHash, false).index);
+            if (owned) {
+                target = std::move(bucket);
+            } else {
+                target = bucket;
+            }
+            m_size++;
+            if (filter) filter->add(keyHash);
         }
     }
 }
@@ -59,45 +401,62 @@ void HashTable::resize() {
  *    if a seed is provided.
  */
 void HashTable::generateOffsets(const size_t seed) {
-    offsets.clear();
+    // a new vector, since snapshots may still probe with the old one
+    const auto newOffsets = std::allocate_shared<std::pmr::vector<size_t>>(getAllocator());
+    newOffsets->reserve(m_capacity > 0 ? m_capacity - 1 : 0);
 
     // Fill offsets vector with 1 ... (capacity - 1)
     for (size_t i = 1; i < m_capacity; i++) {
-        offsets.push_back(i);
+        newOffsets->push_back(i);
     }
 
     // deterministic shuffle if a seed is given
     if (seed > 0) {
         srand(seed); // pseudo-random seed for reproducibility
 
-        for (size_t i = 0; i < offsets.size(); i++) {
-            size_t j = rand() % offsets.size();
-            std::swap(offsets[i], offsets[j]);
+        for (size_t i = 0; i < newOffsets->size(); i++) {
+            size_t j = rand() % newOffsets->size();
+            std::swap((*newOffsets)[i], (*newOffsets)[j]);
         }
     }
+
+    offsets = newOffsets;
 }
 
 /* Purpose: Computes a hash value for a given key.
  * Parameters:
  *    key – string key to hash
  * Returns:
- *    int – hash index within table capacity
+ *    uint64_t – well-mixed hash; the low bits pick the home bucket, and
+ *    buckets and the Bloom filter keep all of it
+ * Behavior:
+ *    Uses the hash kernel CpuDispatch selected for this process.
+ */
+uint64_t HashTable::hash(const std::string_view key) {
+    return keyHash(key);
+}
+
+/* Purpose: Maps a key's hash to its home bucket.
+ * Parameters:
+ *    keyHash – hash(key)
+ * Returns:
+ *    size_t – hash index within table capacity; 0 for a moved-from table,
+ *    whose empty offsets then end the probe at once
  */
-int HashTable::hash(const std::string& key) const {
-    int sum = 0;
-    for (char c : key) sum += c;
-    return sum % m_capacity;
+size_t HashTable::homeIndex(const uint64_t keyHash) const {
+    return m_capacity > 0 ? keyHash % m_capacity : 0;
 }
 
 /* Purpose: Checks if a normal key exists at a given index.
  * Parameters:
  *    key – string key to check
+ *    keyHash – hash(key)
  *    index – bucket index to examine
  * Returns:
  *    true if key exists and is not marked empty
  */
-bool HashTable::isNormalKeyFound(const std::string& key, const size_t index) const {
-    return table[index].getKey() == key && !table[index].isEmpty();
+bool HashTable::isNormalKeyFound(const std::string_view key, const uint64_t keyHash, const size_t index) const {
+    return bucketAt(index).matches(key, keyHash);
 }
 
 /* Purpose: Checks whether the table contains a key.
@@ -107,22 +466,147 @@ bool HashTable::isNormalKeyFound(const std::string& key, const size_t index) con
  *    true if key exists, false otherwise
  */
 bool HashTable::contains(const std::string& key) const {
-    const size_t home = hash(key);
+    const uint64_t keyHash = hash(key);
+    if (filter && !filter->mayContain(keyHash)) return false;
+    const size_t home = homeIndex(keyHash);
 
-    for (size_t i = 0; i < offsets.size(); i++) {
-        const size_t index = (home + offsets[i]) % m_capacity;
+    for (size_t i = 0; i < offsets->size(); i++) {
+        const size_t index = (home + (*offsets)[i]) % m_capacity;
 
-        if (table[index].isEmptySinceStart()) {
+        if (bucketAt(index).isEmptySinceStart()) {
             break; // stop when hitting an ESS
         }
-        if (isNormalKeyFound(key, index)) {
-            return true; // key found
+        if (isNormalKeyFound(key, keyHash, index)) {
+            return !isExpired(index); // key found
         }
     }
 
     return false;
 }
 
+/* Purpose: Walks a key's probe sequence once.
+ * Parameters:
+ *    key – string key to search
+ *    keyHash – hash(key)
+ *    mayExist – false if the key is known to be missing, so the walk can
+ *               stop at the first reusable bucket without comparing keys
+ * Returns:
+ *    ProbeResult – the key's bucket if found; otherwise the first EAR or ESS
+ *    bucket seen on the way, which is where the key would be inserted
+ */
+HashTable::ProbeResult HashTable::probe(const std::string_view key, const uint64_t keyHash, const bool mayExist) const {
+    const size_t home = homeIndex(keyHash);
+    size_t firstFree = NO_BUCKET;
+
+    for (size_t i = 0; i < offsets->size(); i++) {
+        const size_t index = (home + (*offsets)[i]) % m_capacity;
+
+        if (bucketAt(index).isEmptySinceStart()) {
+            if (firstFree == NO_BUCKET) firstFree = index;
+            break; // the key cannot be further along the sequence
+        }
+        if (bucketAt(index).isEmptyAfterRemove()) {
+            if (firstFree == NO_BUCKET) firstFree = index; // reusable, but keep looking for the key
+            if (!mayExist) break;
+        } else if (isNormalKeyFound(key, keyHash, index)) {
+            return {index, true};
+        }
+    }
+
+    return {firstFree, false};
+}
+
+/* Purpose: Finds a key's bucket, inserting the key if it is missing.
+ * Parameters:
+ *    key – string key to find or insert
+ *    value – value stored if the key is inserted
+ * Returns:
+ *    pair of the key's bucket index and whether the key was inserted
+ */
+std::pair<size_t, bool> HashTable::findOrInsertSlot(const std::string& key, const int value) {
+    const uint64_t keyHash = hash(key);
+    const auto [index, claimed] = findOrClaimSlot(key, keyHash);
+    if (claimed) mutableBucketAt(index).load(key, value, keyHash);
+    return {index, claimed};
+}
+
+/* Purpose: Finds a key's bucket, or claims one for it if it is missing.
+ * Parameters:
+ *    key – key to find
+ *    keyHash – hash(key), e.g. stored in another table's bucket
+ *    hint – bucket to try before probing, or NO_BUCKET
+ * Returns:
+ *    pair of the bucket index and whether it was claimed
+ * Behavior:
+ *    Probes once. Only when an insert would push the load factor past 0.5
+ *    (or no bucket is free) does it resize and probe the new table. In
+ *    bounded cache mode a full table evicts one entry instead of resizing.
+ *    A claimed bucket already counts toward size() and the Bloom filter;
+ *    the caller must fill it, with load() or by assigning a bucket for
+ *    the same key, before anything else touches the table.
+ */
+std::pair<size_t, bool> HashTable::findOrClaimSlot(const std::string_view key, const uint64_t keyHash,
+                                                   const size_t hint) {
+    if (hint != NO_BUCKET && isNormalKeyFound(key, keyHash, hint) && !isExpired(hint)) return {hint, false};
+
+    // a bounded table never grows, so clear its tombstones in place
+    if (m_maxEntries > 0 && m_tombstones > m_capacity / 4) rebuild(m_capacity);
+
+    ProbeResult result = probe(key, keyHash, !filter || filter->mayContain(keyHash));
+    if (result.found && !isExpired(result.index)) return {result.index, false};
+    if (result.found) {
+        m_stats.expirations++; // a stale entry is replaced like a new one
+        return {result.index, true};
+    }
+
+    if (m_maxEntries > 0 && m_size >= m_maxEntries) {
+        evictOne();
+        if (result.index == NO_BUCKET) result = probe(key, keyHash, false);
+    } else if ((m_maxEntries == 0 && alpha() >= 0.5) || result.index == NO_BUCKET) {
+        resize();
+        result = probe(key, keyHash, false);
+    }
+
+    if (bucketAt(result.index).isEmptyAfterRemove()) m_tombstones--;
+    m_size++;
+    if (filter) filter->add(keyHash);
+    return {result.index, true};
+}
+
+/* Purpose: Inserts a key, taking over its storage.
+ * Parameters:
+ *    key – key to insert; moved from only if it is inserted
+ *    value – integer value to associate with key
+ * Returns:
+ *    true if insertion succeeded, false if key already exists
+ * Behavior:
+ *    When key uses the table's memory resource, its bytes are adopted and
+ *    inserting costs no allocation for the key.
+ */
+bool HashTable::insertMoved(std::pmr::string&& key, const int value) {
+    const uint64_t keyHash = hash(key);
+    const auto [index, claimed] = findOrClaimSlot(key, keyHash);
+    if (claimed) mutableBucketAt(index).load(std::move(key), value, keyHash);
+    return claimed;
+}
+
+/* Purpose: Inserts a key-value pair, building the key in place.
+ * Parameters:
+ *    key – key to insert, e.g. a literal or a slice of a larger buffer
+ *    value – integer value to associate with key
+ * Returns:
+ *    true if insertion succeeded, false if key already exists
+ * Behavior:
+ *    Like insert(), without first materializing a std::string, so a long
+ *    key is allocated once, in the table's memory resource.
+ */
+bool HashTable::emplace(const std::string_view key, const int value) {
+    const uint64_t keyHash = hash(key);
+    const auto [index, claimed] = findOrClaimSlot(key, keyHash);
+    if (claimed) mutableBucketAt(index).load(key, value, keyHash);
+    return claimed;
+}
+
 /* Purpose: Inserts a key-value pair into the hash table.
  * Parameters:
  *    key – string key to insert
@@ -131,28 +615,63 @@ bool HashTable::contains(const std::string& key) const {
  *    true if insertion succeeded, false if key already exists
  * Behavior:
  *    Resizes the table if load factor >= 0.5. Uses pseudo-random probing
- *    to find an empty bucket for insertion.
+ *    to find an empty bucket for insertion, checking for a duplicate along
+ *    the same walk.
  */
 bool HashTable::insert(const std::string& key, const int value) {
-    if (contains(key)) return false;
-    if (alpha() >= 0.5) resize();
-
-    // seed with key length
-    generateOffsets(key.length());
-    const size_t home = hash(key);
-
-    // pseudo-random probing
-    for (size_t i = 0; i < offsets.size(); i++) {
-        const size_t index = (home + offsets[i]) % m_capacity;
-        if (table[index].isEmpty()) {
-            table[index].load(key, value);
-            table[index].makeNormal();
-            m_size++;
-            return true;
-        }
-    }
+    return findOrInsertSlot(key, value).second;
+}
 
-    return false;
+/* Purpose: Inserts a key-value pair, or overwrites the value if the key exists.
+ * Parameters:
+ *    key – string key to insert or update
+ *    value – integer value to store
+ * Returns:
+ *    true if the key was inserted, false if an existing value was replaced
+ */
+bool HashTable::insertOrAssign(const std::string& key, const int value) {
+    const auto [index, inserted] = findOrInsertSlot(key, value);
+    if (!inserted) mutableBucketAt(index).setValue(value);
+    return inserted;
+}
+
+/* Purpose: Inserts a key-value pair only if the key is missing.
+ * Parameters:
+ *    key – string key to insert
+ *    value – integer value stored if the key is inserted
+ * Returns:
+ *    pair of a reference to the key's value and whether the key was inserted;
+ *    the reference is valid until the next insert that resizes the table
+ *    or the next snapshot()
+ */
+std::pair<int&, bool> HashTable::tryEmplace(const std::string& key, const int value) {
+    const auto [index, inserted] = findOrInsertSlot(key, value);
+    return {mutableBucketAt(index).getValueRef(), inserted};
+}
+
+/* Purpose: Returns the value for a key, inserting a default if it is missing.
+ * Parameters:
+ *    key – string key to find or insert
+ *    defaultValue – value stored if the key is inserted (defaults to 0)
+ * Returns:
+ *    reference to the key's value, valid until the next insert that resizes
+ *    or the next snapshot()
+ */
+int& HashTable::findOrInsert(const std::string& key, const int defaultValue) {
+    return mutableBucketAt(findOrInsertSlot(key, defaultValue).first).getValueRef();
+}
+
+/* Purpose: Adds delta to the value stored under key in a single probe.
+ * Parameters:
+ *    key – string key to update
+ *    delta – amount to add; a missing key is inserted with value delta
+ * Returns:
+ *    int – the key's new value
+ */
+int HashTable::merge(const std::string& key, const int delta) {
+    const auto [index, inserted] = findOrInsertSlot(key, delta);
+    if (!inserted) mutableBucketAt(index).getValueRef() += delta;
+    return bucketAt(index).getValue();
 }
 
 /* Purpose: Removes a key-value pair from the table.
@@ -164,24 +683,140 @@ bool HashTable::insert(const std::string& key, const int value) {
  *    Marks bucket as empty-after-remove without altering other buckets.
  */
 bool HashTable::remove(const std::string& key) {
-    const size_t home = hash(key);
+    const uint64_t keyHash = hash(key);
+    if (filter && !filter->mayContain(keyHash)) return false;
+    const size_t home = homeIndex(keyHash);
 
-    for (size_t i = 0; i < offsets.size(); i++) {
-        const size_t index = (home + offsets[i]) % m_capacity;
+    for (size_t i = 0; i < offsets->size(); i++) {
+        const size_t index = (home + (*offsets)[i]) % m_capacity;
 
-        if (table[index].isEmptySinceStart()) {
+        if (bucketAt(index).isEmptySinceStart()) {
             break;
         }
-        if (isNormalKeyFound(key, index)) {
-            table[index].makeEAR();
-            m_size--;
-            return true;
+        if (isNormalKeyFound(key, keyHash, index)) {
+            const bool live = !isExpired(index);
+            eraseAt(index);
+            return live;
         }
     }
 
     return false;
 }
 
+/* Purpose: Removes a batch of keys.
+ * Parameters:
+ *    keys – keys to remove; missing and repeated keys are skipped
+ * Returns:
+ *    size_t – number of live entries removed
+ * Behavior:
+ *    Like remove() per key, but the Bloom filter check and tombstone
+ *    compaction run once for the batch, through finishSweep().
+ */
+size_t HashTable::removeMany(const std::span<const std::string> keys) {
+    size_t removed = 0;
+    for (const std::string& key : keys) {
+        const uint64_t keyHash = hash(key);
+        if (filter && !filter->mayContain(keyHash)) continue;
+
+        const ProbeResult result = probe(key, keyHash);
+        if (!result.found) continue;
+        if (!isExpired(result.index)) removed++;
+        eraseAt(result.index, false);
+    }
+    finishSweep();
+    return removed;
+}
+
+/* Purpose: Finds a key's live entry without hashing it.
+ * Parameters:
+ *    key – key to find
+ *    keyHash – hash(key), e.g. stored in another table's bucket
+ *    hint – bucket to try before probing, or NO_BUCKET
+ * Returns:
+ *    size_t – index of the key's bucket, or NO_BUCKET if it is missing or
+ *    expired
+ */
+size_t HashTable::locate(const std::string_view key, const uint64_t keyHash, const size_t hint) const {
+    size_t index = hint;
+    if (index == NO_BUCKET || !isNormalKeyFound(key, keyHash, index)) {
+        if (filter && !filter->mayContain(keyHash)) return NO_BUCKET;
+        const ProbeResult result = probe(key, keyHash);
+        if (!result.found) return NO_BUCKET;
+        index = result.index;
+    }
+    return isExpired(index) ? NO_BUCKET : index;
+}
+
+/* Purpose: Removes the entries whose keys are, or are not, in another table.
+ * Parameters:
+ *    other – table to check keys against
+ *    keepShared – true to keep keys found in other, false to keep the rest
+ * Returns:
+ *    size_t – number of live entries removed
+ * Behavior:
+ *    One sweep like eraseIf(). Keys are looked up in other by their stored
+ *    hash, at the same index first when both capacities match.
+ */
+size_t HashTable::sweepAgainst(const HashTable& other, const bool keepShared) {
+    const bool lockstep = other.m_capacity == m_capacity;
+    const auto now = std::chrono::steady_clock::now();
+    size_t removed = 0;
+
+    for (size_t index = 0; index < m_capacity; index++) {
+        const HashTableBucket& bucket = bucketAt(index);
+        if (bucket.isEmpty()) continue;
+        if (bucket.isExpired(now)) {
+            m_stats.expirations++;
+        } else {
+            const bool shared = other.locate(bucket.getKeyView(), bucket.getHash(), lockstep ? index : NO_BUCKET)
+                    != NO_BUCKET;
+            if (shared == keepShared) continue;
+            removed++;
+        }
+        eraseAt(index, false);
+    }
+    finishSweep();
+    return removed;
+}
+
+/* Purpose: Keeps only the keys that are also in another table.
+ * Parameters:
+ *    other – table whose keys to keep
+ * Returns:
+ *    size_t – number of entries removed
+ * Behavior:
+ *    Values stay as they are in this table. Takes one sweep, see
+ *    sweepAgainst().
+ */
+size_t HashTable::intersect(const HashTable& other) {
+    return sweepAgainst(other, true);
+}
+
+/* Purpose: Removes every key that is also in another table.
+ * Parameters:
+ *    other – table whose keys to remove
+ * Returns:
+ *    size_t – number of entries removed
+ */
+size_t HashTable::difference(const HashTable& other) {
+    return sweepAgainst(other, false);
+}
+
+/* Purpose: Grows the table so it can hold a number of entries without resizing.
+ * Parameters:
+ *    entries – entries the table should hold at load factor 0.5
+ * Behavior:
+ *    Rebuilds at most once, to the current capacity doubled as often as
+ *    needed. Never shrinks (see compact()) and does nothing in bounded cache
+ *    mode, whose capacity is fixed.
+ */
+void HashTable::reserve(const size_t entries) {
+    if (m_maxEntries > 0) return;
+    size_t newCapacity = std::max<size_t>(m_capacity, 1);
+    while (entries > newCapacity / 2) newCapacity *= 2;
+    if (newCapacity != m_capacity) rebuild(newCapacity);
+}
+
 /* Purpose: Retrieves the value associated with a key.
  * Parameters:
  *    key – string key to lookup
@@ -189,16 +824,19 @@ bool HashTable::remove(const std::string& key) {
  *    optional<int> containing value if key exists, nullopt otherwise
  */
 std::optional<int> HashTable::get(const std::string& key) const {
-    const size_t home = hash(key);
+    const uint64_t keyHash = hash(key);
+    if (filter && !filter->mayContain(keyHash)) return std::nullopt;
+    const size_t home = homeIndex(keyHash);
 
-    for (size_t i = 0; i < offsets.size(); i++) {
-        const size_t index = (home + offsets[i]) % m_capacity;
+    for (size_t i = 0; i < offsets->size(); i++) {
+        const size_t index = (home + (*offsets)[i]) % m_capacity;
 
-        if (table[index].isEmptySinceStart()) {
+        if (bucketAt(index).isEmptySinceStart()) {
             break;
         }
-        if (isNormalKeyFound(key, index)) {
-            return table[index].getValue();
+        if (isNormalKeyFound(key, keyHash, index)) {
+            if (isExpired(index)) break;
+            return bucketAt(index).getValue();
         }
     }
 
@@ -206,6 +844,61 @@ std::optional<int> HashTable::get(const std::string& key) const {
 }
 
 
+/* Purpose: Retrieves the value for a key as a coroutine that overlaps its cache misses.
+ * Parameters:
+ *    key – key to look up; the bytes it views must outlive the task
+ * Returns:
+ *    GetTask – not yet started; drive it with runInterleaved() or run()
+ * Behavior:
+ *    Walks the same probe sequence as get(). Before touching each bucket it
+ *    prefetches the bucket and suspends. For a bucket whose hash and length
+ *    match it also prefetches the key bytes, which live outside the bucket
+ *    for long keys, and suspends again. The table must not be modified
+ *    while tasks are in flight.
+ */
+GetTask HashTable::asyncGet(const std::string_view key) const {
+    const uint64_t keyHash = hash(key);
+    if (filter && !filter->mayContain(keyHash)) co_return std::nullopt;
+    const size_t home = homeIndex(keyHash);
+
+    for (size_t i = 0; i < offsets->size(); i++) {
+        const size_t index = (home + (*offsets)[i]) % m_capacity;
+        const HashTableBucket& bucket = bucketAt(index);
+        prefetchRead(&bucket);
+        co_await std::suspend_always{}; // other lookups run while the bucket loads
+
+        if (bucket.isEmptySinceStart()) break;
+        if (bucket.isEmpty() || bucket.getHash() != keyHash || bucket.getKeyView().size() != key.size()) continue;
+
+        prefetchRead(bucket.getKeyView().data());
+        co_await std::suspend_always{};
+        if (bucket.matches(key, keyHash)) {
+            if (isExpired(index)) break;
+            co_return bucket.getValue();
+        }
+    }
+
+    co_return std::nullopt;
+}
+
+/* Purpose: Retrieves the values for many keys, interleaving their probes.
+ * Parameters:
+ *    keys – keys to look up
+ *    groupSize – lookups in flight at once (1 behaves like repeated get())
+ * Returns:
+ *    vector<optional<int>> – one result per key, in the order of keys
+ * Behavior:
+ *    Runs an asyncGet() per key through runInterleaved(). On tables much
+ *    larger than the cache, a group of 8 to 16 hides most of the memory
+ *    latency that get() pays once per probe.
+ */
+std::vector<std::optional<int>> HashTable::getMany(const std::vector<std::string>& keys, const size_t groupSize) const {
+    std::vector<std::optional<int>> results(keys.size());
+    runInterleaved(keys.size(), groupSize, [&](const size_t i) { return asyncGet(keys[i]); },
+                   [&](const size_t i, const std::optional<int> result) { results[i] = result; });
+    return results;
+}
+
 /* Purpose: Returns all keys currently in the hash table.
  * Returns:
  *    vector<string> containing all active keys
@@ -214,19 +907,52 @@ std::vector<std::string> HashTable::keys() const {
     std::vector<std::string> keys;
 
     for (size_t i = 0; i < m_capacity; i++) {
-        if (!table[i].isEmpty()) {
-            keys.push_back(table[i].getKey());
+        if (!bucketAt(i).isEmpty() && !isExpired(i)) {
+            keys.emplace_back(bucketAt(i).getKeyView());
         }
     }
 
     return keys;
 }
 
+/* Purpose: Returns all keys currently in the hash table, using several threads.
+ * Parameters:
+ *    threads – worker threads (0 = hardware concurrency)
+ * Returns:
+ *    vector<string> containing all active keys, in bucket order like keys()
+ * Behavior:
+ *    A first parallel pass counts the live entries of each page. A prefix
+ *    sum then gives every page its own slice of the preallocated output,
+ *    and a second pass fills the slices in parallel with no locking.
+ */
+std::vector<std::string> HashTable::keys(const size_t threads) const {
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<size_t> sliceStart(pages.size() + 1, 0);
+
+    parallelChunks(pages.size(), threads, [&](const size_t page, size_t) {
+        size_t live = 0;
+        const auto count = [&live](std::string_view, int) { live++; };
+        forEachInPage(page, now, count);
+        sliceStart[page + 1] = live;
+    });
+    for (size_t page = 0; page < pages.size(); page++) sliceStart[page + 1] += sliceStart[page];
+
+    std::vector<std::string> keys(sliceStart.back());
+    parallelChunks(pages.size(), threads, [&](const size_t page, size_t) {
+        size_t out = sliceStart[page];
+        const auto copy = [&](const std::string_view key, int) { keys[out++].assign(key); };
+        forEachInPage(page, now, copy);
+    });
+
+    return keys;
+}
+
 /* Purpose: Returns current load factor of the table.
  * Returns:
- *    double – ratio of size to capacity
+ *    double – ratio of size to capacity, or 0 for a moved-from table
  */
 double HashTable::alpha() const {
+    if (m_capacity == 0) return 0.0;
     return static_cast<double>(m_size) / static_cast<double>(m_capacity);
 }
 
@@ -246,29 +972,32 @@ size_t HashTable::size() const {
     return m_size;
 }
 
+/* Purpose: Returns the allocator used by the table.
+ * Returns:
+ *    allocator_type – polymorphic allocator bound to the table's memory resource
+ */
+HashTable::allocator_type HashTable::getAllocator() const {
+    return pages.get_allocator();
+}
+
+/* Purpose: Returns the memory resource backing the table.
+ * Returns:
+ *    memory_resource* – resource used for buckets, offsets and keys
+ */
+std::pmr::memory_resource* HashTable::resource() const {
+    return pages.get_allocator().resource();
+}
+
 /* Purpose: Accesses value by key using bracket notation.
  * Parameters:
  *    key – string key to access
  * Returns:
  *    reference to the value associated with the key
- * Throws:
- *    exception if key does not exist
+ * Behavior:
+ *    Like std::unordered_map, a missing key is inserted with value 0.
  */
 int& HashTable::operator[](const std::string& key) {
-    size_t home = hash(key);
-
-    for (size_t i = 0; i < offsets.size(); i++) {
-        const size_t index = (home + offsets[i]) % m_capacity;
-
-        if (table[index].isEmptySinceStart()) {
-            break;
-        }
-        if (isNormalKeyFound(key, index)) {
-            return table[index].getValueRef();
-        }
-    }
-
-    throw std::exception();
+    return findOrInsert(key);
 }
 
 /* Purpose: Prints the hash table to an output stream.
@@ -284,18 +1013,554 @@ std::ostream& operator<<(std::ostream& os, const HashTable& table) {
 
 /* Purpose: Returns a string representation of the hash table.
  * Returns:
- *    string – formatted output of all non-empty buckets
+ *    string – formatted output of all non-empty buckets; entries whose TTL
+ *    has passed are left out, as get() and keys() treat them as missing
  */
 std::string HashTable::printMe() const {
     std::ostringstream out;
 
     for (size_t i = 0; i < m_capacity; i++) {
-        const HashTableBucket bucket = table[i];
+        const HashTableBucket& bucket = bucketAt(i);
 
-        if (!bucket.isEmpty()) {
+        if (!bucket.isEmpty() && !isExpired(i)) {
             out << "Bucket " << i << ": " << bucket << "\n";
         }
     }
 
     return out.str();
-}
\ No newline at end of file
+}
+
+/* Purpose: Builds an immutable, read-optimized copy of the table.
+ * Parameters:
+ *    threads – worker threads used by the build (0 = hardware concurrency)
+ * Returns:
+ *    FrozenHashTable – holding every live key-value pair, where each lookup
+ *    is one hash plus one probe with no load-factor slack
+ * Behavior:
+ *    Entries whose TTL has passed are left out, as in keys(); a frozen
+ *    table has no expiry of its own.
+ */
+FrozenHashTable HashTable::freeze(const size_t threads) const {
+    std::vector<std::pair<std::string, int>> entries;
+    entries.reserve(m_size);
+
+    for (size_t i = 0; i < m_capacity; i++) {
+        if (!bucketAt(i).isEmpty() && !isExpired(i)) {
+            entries.emplace_back(bucketAt(i).getKey(), bucketAt(i).getValue());
+        }
+    }
+
+    return FrozenHashTable(entries, threads);
+}
+
+/* Purpose: Refills the filter from the keys currently in the table.
+ * Behavior:
+ *    Drops the bits of removed keys, which a Bloom filter cannot delete.
+ */
+void HashTable::rebuildFilter() {
+    filter = BloomFilter(m_capacity / 2, m_filterBitsPerKey, getAllocator());
+
+    for (size_t i = 0; i < m_capacity; i++) {
+        if (!bucketAt(i).isEmpty()) filter->add(bucketAt(i).getHash());
+    }
+}
+
+/* Purpose: Puts a Bloom filter in front of contains(), get() and remove().
+ * Parameters:
+ *    bitsPerKey – filter bits per key at maximum load (10 gives about 1%
+ *                 false positives)
+ * Behavior:
+ *    A missing key is then usually rejected with one cache-line read instead
+ *    of a probe-sequence walk. insert() adds to the filter, resize() rebuilds
+ *    it for the new capacity, and remove() rebuilds it once removed keys
+ *    outnumber live ones.
+ */
+void HashTable::enableFilter(const size_t bitsPerKey) {
+    m_filterBitsPerKey = bitsPerKey;
+    rebuildFilter();
+}
+
+/* Purpose: Removes the negative-lookup filter.
+ */
+void HashTable::disableFilter() {
+    filter.reset();
+    m_filterBitsPerKey = 0;
+}
+
+/* Purpose: Returns the negative-lookup filter, for statistics.
+ * Returns:
+ *    pointer to the filter, or nullptr if enableFilter() was not called
+ */
+const BloomFilter* HashTable::getFilter() const {
+    return filter ? &*filter : nullptr;
+}
+
+/* Purpose: Returns a consistent, read-only view of the table.
+ * Returns:
+ *    HashTable – sharing this table's bucket pages and offsets
+ * Behavior:
+ *    Takes O(capacity / PAGE_BUCKETS) time and copies no buckets. Later
+ *    writes to this table copy only the pages they touch, so the snapshot
+ *    keeps its contents and can be read, e.g. with keys() or printMe(), on
+ *    another thread without locking. Taking the snapshot itself must not
+ *    overlap a write. The snapshot has no Bloom filter and is not bounded.
+ */
+HashTable HashTable::snapshot() const {
+    HashTable view(1, getAllocator());
+    view.m_capacity = m_capacity;
+    view.m_size = m_size;
+    view.pages = pages;
+    view.blockEpochs = blockEpochs;
+    view.m_epoch = m_epoch;
+    view.offsets = offsets;
+    view.m_tombstones = m_tombstones;
+    return view;
+}
+
+/* Purpose: Counts bucket pages currently shared with snapshots.
+ * Returns:
+ *    size_t – pages a write would have to copy first
+ */
+size_t HashTable::sharedPages() const {
+    return std::count_if(pages.begin(), pages.end(), [](const std::shared_ptr<BucketPage>& page) {
+        return page.use_count() > 1;
+    });
+}
+
+/* Purpose: Makes resizes hash every key again, as they did before buckets
+ *          cached their hash.
+ * Parameters:
+ *    rehash – true to hash keys again, false to use the cached hashes
+ * Behavior:
+ *    The table ends up the same either way; this exists so a benchmark can
+ *    measure what the cached hash saves. Moves keep the setting; copies
+ *    start with it off.
+ */
+void HashTable::setRehashOnResize(const bool rehash) {
+    m_rehashOnResize = rehash;
+}
+
+/* Purpose: Reports what a bucket holds, e.g. for a profiler.
+ * Parameters:
+ *    index – bucket index, below capacity()
+ * Returns:
+ *    BucketType – NORMAL for an entry (expired or not), ESS or EAR if empty
+ */
+BucketType HashTable::bucketType(const size_t index) const {
+    const HashTableBucket& bucket = bucketAt(index);
+    if (bucket.isEmptySinceStart()) return BucketType::ESS;
+    return bucket.isEmptyAfterRemove() ? BucketType::EAR : BucketType::NORMAL;
+}
+
+/* Purpose: Lists the buckets a lookup of key examines, e.g. for a profiler.
+ * Parameters:
+ *    key – key to trace
+ * Returns:
+ *    vector<size_t> – bucket indices in probe order; the last one holds
+ *    the key if it is present, else it is the ESS bucket that ended the
+ *    search (or the sequence ran out)
+ * Behavior:
+ *    Walks the sequence exactly as get() does, minus the Bloom filter,
+ *    which would reject most missing keys before any bucket is read.
+ */
+std::vector<size_t> HashTable::probePath(const std::string_view key) const {
+    const uint64_t keyHash = hash(key);
+    const size_t home = homeIndex(keyHash);
+    std::vector<size_t> path;
+
+    for (size_t i = 0; i < offsets->size(); i++) {
+        const size_t index = (home + (*offsets)[i]) % m_capacity;
+        path.push_back(index);
+        if (bucketAt(index).isEmptySinceStart() || isNormalKeyFound(key, keyHash, index)) break;
+    }
+    return path;
+}
+
+/* Purpose: Ends the current epoch of writes, for replication.
+ * Returns:
+ *    uint64_t – number of the epoch just ended; exportDelta() of it later
+ *    holds only what was written after this call
+ */
+uint64_t HashTable::checkpoint() {
+    return m_epoch++;
+}
+
+/* Purpose: Encodes the buckets written since a checkpoint, for a replica.
+ * Parameters:
+ *    sinceEpoch – value a checkpoint() returned; 0 exports the whole table
+ * Returns:
+ *    string – binary image for applyDelta()
+ * Behavior:
+ *    Writes are tracked per block of DIRTY_BUCKETS buckets, which is finer
+ *    than the copy-on-write pages: a 1% mutation rate touches nearly every
+ *    page but only a few percent of blocks. Runs of consecutive dirty blocks
+ *    are encoded bucket by bucket: a tag byte, then for an entry its key
+ *    length, key bytes, value and, if it has a TTL, the nanoseconds left.
+ *    Hashes are not sent. A resize, compact() or clear() dirties every
+ *    block, so the next delta is a full one. Integers are in host byte
+ *    order, so both ends must share an architecture, and both must hash
+ *    with the same kernel (see keyHash()).
+ */
+std::string HashTable::exportDelta(const uint64_t sinceEpoch) const {
+    DeltaHeader header{};
+    std::memcpy(header.magic, DELTA_MAGIC, sizeof(DELTA_MAGIC));
+    header.sinceEpoch = sinceEpoch;
+    header.throughEpoch = m_epoch;
+    header.capacity = m_capacity;
+    header.hashCheck = hash(DELTA_HASH_PROBE);
+
+    std::string out(sizeof(DeltaHeader), '\0');
+    const auto now = std::chrono::steady_clock::now();
+    size_t dirtyBlocks = 0;
+
+    for (size_t block = 0; block < blockEpochs.size();) {
+        if (blockEpochs[block] <= sinceEpoch) {
+            block++;
+            continue;
+        }
+        size_t end = block + 1;
+        while (end < blockEpochs.size() && blockEpochs[end] > sinceEpoch) end++;
+
+        const size_t first = block << DIRTY_SHIFT;
+        const size_t last = std::min(end << DIRTY_SHIFT, m_capacity);
+        appendRaw<uint64_t>(out, first);
+        appendRaw<uint64_t>(out, last - first);
+        for (size_t index = first; index < last; index++) {
+            const HashTableBucket& bucket = bucketAt(index);
+            if (bucket.isEmpty()) {
+                out.push_back(static_cast<char>(bucket.isEmptyAfterRemove() ? DELTA_EAR : DELTA_ESS));
+                continue;
+            }
+            const std::string_view key = bucket.getKeyView();
+            out.push_back(static_cast<char>(bucket.hasExpiry() ? DELTA_NORMAL_TTL : DELTA_NORMAL));
+            appendRaw<uint32_t>(out, static_cast<uint32_t>(key.size()));
+            out.append(key);
+            appendRaw<int32_t>(out, bucket.getValue());
+            if (bucket.hasExpiry()) {
+                const auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(bucket.getExpiry() - now);
+                appendRaw<int64_t>(out, std::max<int64_t>(left.count(), 0));
+            }
+        }
+
+        dirtyBlocks += end - block;
+        header.runCount++;
+        block = end;
+    }
+
+    header.full = dirtyBlocks == blockEpochs.size();
+    std::memcpy(out.data(), &header, sizeof(header));
+    return out;
+}
+
+/* Purpose: Brings a replica up to date with an exportDelta() image.
+ * Parameters:
+ *    delta – image exported by the primary table
+ * Throws:
+ *    runtime_error if the image is malformed, including a capacity of 0 or
+ *    a full image whose runs do not cover exactly its capacity;
+ *    invalid_argument if it does not follow on from the last image applied,
+ *    i.e. its sinceEpoch is neither 0 nor before that image's epoch, if
+ *    the primary's capacity changed and the image is not a full one, or if
+ *    the primary hashed keys with a different kernel than this process
+ * Behavior:
+ *    The image is checked completely before the table is touched. Each
+ *    bucket it holds overwrites the bucket at the same index, so the replica
+ *    ends up with the primary's exact layout; keys are hashed again here.
+ *    TTLs restart from now with the time that was left. A replica must not
+ *    be written to in any other way.
+ */
+void HashTable::applyDelta(const std::string_view delta) {
+    DeltaReader reader(delta);
+    const auto header = reader.read<DeltaHeader>();
+    if (std::memcmp(header.magic, DELTA_MAGIC, sizeof(DELTA_MAGIC)) != 0) {
+        throw std::runtime_error("HashTable: not a delta image");
+    }
+    // every bucket of a full image takes at least its tag byte, so its capacity is bounded by the length
+    if (header.capacity == 0 || (header.full && header.capacity > delta.size() - sizeof(DeltaHeader))) {
+        throw std::runtime_error("HashTable: delta capacity does not match its length");
+    }
+    if (header.hashCheck != hash(DELTA_HASH_PROBE)) {
+        throw std::invalid_argument("HashTable: delta was exported with a different hash kernel");
+    }
+    if (header.sinceEpoch != 0 && header.sinceEpoch >= m_replicaEpoch) {
+        throw std::invalid_argument("HashTable: delta does not follow the last one applied");
+    }
+    if (header.capacity != m_capacity && !header.full) {
+        throw std::invalid_argument("HashTable: partial delta for a different capacity");
+    }
+
+    // calls fn(index, tag, key, value, nanoseconds left or -1) for every bucket in the image
+    const auto forEachBucket = [&](auto&& fn) {
+        DeltaReader runs = reader;
+        uint64_t covered = 0;
+        for (uint64_t r = 0; r < header.runCount; r++) {
+            const auto first = runs.read<uint64_t>();
+            const auto count = runs.read<uint64_t>();
+            if (first > header.capacity || count > header.capacity - first) {
+                throw std::runtime_error("HashTable: delta run out of range");
+            }
+            covered += count;
+            for (uint64_t index = first; index < first + count; index++) {
+                const auto tag = runs.read<uint8_t>();
+                if (tag > DELTA_NORMAL_TTL) throw std::runtime_error("HashTable: corrupt delta");
+                std::string_view key;
+                int32_t value = 0;
+                int64_t left = -1;
+                if (tag >= DELTA_NORMAL) {
+                    key = runs.take(runs.read<uint32_t>());
+                    value = runs.read<int32_t>();
+                    if (tag == DELTA_NORMAL_TTL) left = runs.read<int64_t>();
+                }
+                fn(static_cast<size_t>(index), tag, key, value, left);
+            }
+        }
+        if (!runs.atEnd()) throw std::runtime_error("HashTable: trailing bytes after delta");
+        if (header.full && covered != header.capacity) {
+            throw std::runtime_error("HashTable: full delta does not cover every bucket");
+        }
+    };
+    forEachBucket([](size_t, uint8_t, std::string_view, int32_t, int64_t) {});
+
+    if (header.capacity != m_capacity) {
+        m_capacity = header.capacity;
+        allocatePages();
+        generateOffsets(m_capacity);
+        m_size = 0;
+        m_tombstones = 0;
+        m_clockHand = 0;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    forEachBucket([&](const size_t index, const uint8_t tag, const std::string_view key, const int32_t value,
+                      const int64_t left) {
+        HashTableBucket& bucket = mutableBucketAt(index);
+        if (!bucket.isEmpty()) {
+            m_size--;
+        } else if (bucket.isEmptyAfterRemove()) {
+            m_tombstones--;
+        }
+
+        if (tag == DELTA_ESS) {
+            bucket.makeESS();
+        } else if (tag == DELTA_EAR) {
+            bucket.makeEAR();
+            m_tombstones++;
+        } else {
+            bucket.load(key, value, hash(key));
+            if (left >= 0) bucket.setExpiry(now + std::chrono::nanoseconds(left));
+            m_size++;
+        }
+    });
+
+    if (filter) rebuildFilter();
+    m_replicaEpoch = header.throughEpoch;
+}
+
+/* Purpose: Marks a bucket's entry as removed.
+ * Parameters:
+ *    index – bucket holding a NORMAL entry
+ *    checkFilter – false in bulk removals, which call finishSweep() once
+ *                  at the end instead
+ */
+void HashTable::eraseAt(const size_t index, const bool checkFilter) {
+    mutableBucketAt(index).makeEAR();
+    m_size--;
+    m_tombstones++;
+    // removed keys stay in the filter; rebuild once they outnumber live keys
+    if (checkFilter && filter && filter->count() > 2 * m_size + 64) rebuildFilter();
+}
+
+/* Purpose: Tidies up after a bulk removal.
+ * Behavior:
+ *    Compacts the table once tombstones fill a quarter of its buckets, as
+ *    probes for missing keys would otherwise walk past them. Otherwise
+ *    rebuilds the Bloom filter if removed keys outnumber live ones.
+ */
+void HashTable::finishSweep() {
+    if (m_tombstones > m_capacity / 4) {
+        compact();
+    } else if (filter && filter->count() > 2 * m_size + 64) {
+        rebuildFilter();
+    }
+}
+
+/* Purpose: Checks whether a NORMAL bucket's TTL has run out.
+ * Parameters:
+ *    index – bucket to check
+ * Returns:
+ *    true if the entry is stale; reads the clock only for entries with a TTL
+ */
+bool HashTable::isExpired(const size_t index) const {
+    const HashTableBucket& bucket = bucketAt(index);
+    return bucket.hasExpiry() && bucket.isExpired(std::chrono::steady_clock::now());
+}
+
+/* Purpose: Frees one entry using the CLOCK (second-chance) policy.
+ * Behavior:
+ *    The hand sweeps the bucket array from where it last stopped. An
+ *    expired entry is taken at once; a referenced one has its access bit
+ *    cleared and is passed over; the first unreferenced one is evicted.
+ *    The first sweep clears every bit, so two sweeps always find a victim.
+ */
+void HashTable::evictOne() {
+    const auto now = std::chrono::steady_clock::now();
+
+    for (size_t step = 0; step < 2 * m_capacity; step++) {
+        const size_t index = m_clockHand;
+        m_clockHand = (m_clockHand + 1) % m_capacity;
+
+        const HashTableBucket& bucket = bucketAt(index);
+        if (bucket.isEmpty()) continue;
+        if (bucket.isExpired(now)) {
+            eraseAt(index);
+            m_stats.expirations++;
+            return;
+        }
+        if (bucket.isReferenced()) {
+            mutableBucketAt(index).clearReferenced();
+            continue;
+        }
+        eraseAt(index);
+        m_stats.evictions++;
+        return;
+    }
+}
+
+/* Purpose: Inserts or overwrites a key whose entry expires after a TTL.
+ * Parameters:
+ *    key – string key to insert or update
+ *    value – integer value to store
+ *    ttl – how long the entry stays visible
+ * Returns:
+ *    true if the key was inserted, false if an existing value was replaced
+ * Behavior:
+ *    Once the TTL has passed, get(), contains(), lookup() and keys() treat
+ *    the key as missing. The bucket itself is reclaimed lazily, by lookup(),
+ *    remove(), the next insert of the key, the CLOCK sweep or a rebuild.
+ */
+bool HashTable::insertWithTtl(const std::string& key, const int value, const std::chrono::steady_clock::duration ttl) {
+    const auto [index, inserted] = findOrInsertSlot(key, value);
+    HashTableBucket& bucket = mutableBucketAt(index);
+    bucket.setValue(value);
+    bucket.setExpiry(std::chrono::steady_clock::now() + ttl);
+    return inserted;
+}
+
+/* Purpose: Reads a key the way a cache does.
+ * Parameters:
+ *    key – string key to lookup
+ * Returns:
+ *    optional<int> containing value if key exists and is fresh, nullopt otherwise
+ * Behavior:
+ *    Unlike get(), counts a hit or miss, sets the bucket's CLOCK access
+ *    bit, and reclaims the bucket of an expired entry.
+ */
+std::optional<int> HashTable::lookup(const std::string& key) {
+    const uint64_t keyHash = hash(key);
+    if (!filter || filter->mayContain(keyHash)) {
+        const ProbeResult result = probe(key, keyHash);
+        if (result.found && isExpired(result.index)) {
+            eraseAt(result.index);
+            m_stats.expirations++;
+        } else if (result.found) {
+            if (!bucketAt(result.index).isReferenced()) mutableBucketAt(result.index).markReferenced();
+            m_stats.hits++;
+            return bucketAt(result.index).getValue();
+        }
+    }
+
+    m_stats.misses++;
+    return std::nullopt;
+}
+
+/* Purpose: Bounds the table to a fixed number of entries.
+ * Parameters:
+ *    maxEntries – most entries the table will hold
+ * Behavior:
+ *    Grows the table once so maxEntries fits at load factor 0.5, then never
+ *    resizes again: inserting into a full table evicts an entry with
+ *    evictOne(). Entries beyond the limit are evicted right away.
+ */
+void HashTable::enableEviction(const size_t maxEntries) {
+    if (maxEntries == 0) throw std::invalid_argument("enableEviction: maxEntries must be positive");
+
+    size_t newCapacity = std::max<size_t>(m_capacity, 1);
+    while (newCapacity < 2 * maxEntries) newCapacity *= 2;
+    if (newCapacity != m_capacity) rebuild(newCapacity);
+
+    m_maxEntries = maxEntries;
+    while (m_size > m_maxEntries) evictOne();
+}
+
+/* Purpose: Returns the table to unbounded growth.
+ */
+void HashTable::disableEviction() {
+    m_maxEntries = 0;
+}
+
+/* Purpose: Returns the entry limit of bounded cache mode.
+ * Returns:
+ *    size_t – the limit, or 0 if the table is unbounded
+ */
+size_t HashTable::maxEntries() const {
+    return m_maxEntries;
+}
+
+/* Purpose: Returns the cache counters.
+ * Returns:
+ *    CacheStats – hits and misses seen by lookup(), plus evictions and
+ *    expirations
+ */
+HashTable::CacheStats HashTable::cacheStats() const {
+    return m_stats;
+}
+
+/* Purpose: Breaks down the memory the table holds from its resource.
+ * Returns:
+ *    MemoryUsage – bucket slots, live key storage, tombstones and overhead;
+ *    total() matches what the resource has handed out for this table
+ * Behavior:
+ *    Takes O(capacity) time. Pages and offsets shared with a snapshot are
+ *    counted in full by each table sharing them; the empty page clear()
+ *    shares between page slots is counted once. Expired entries that were
+ *    not dropped yet count as live.
+ */
+HashTable::MemoryUsage HashTable::memoryUsage() const {
+    MemoryUsage usage;
+    usage.overheadBytes = pages.capacity() * sizeof(std::shared_ptr<BucketPage>) + blockEpochs.capacity() * sizeof(uint64_t)
+            + sharedBlockBytes<std::pmr::vector<size_t>>() + offsets->capacity() * sizeof(size_t);
+    if (filter) usage.overheadBytes += filter->bytes();
+
+    for (size_t p = 0; p < pages.size(); p++) {
+        if (p > 0 && pages[p] == pages[p - 1]) continue; // one empty page shared since clear()
+        const BucketPage& page = *pages[p];
+        usage.overheadBytes += sharedBlockBytes<BucketPage>();
+        usage.slotBytes += page.capacity() * sizeof(HashTableBucket);
+        for (const HashTableBucket& bucket : page) {
+            if (bucket.isEmptyAfterRemove()) {
+                usage.slotBytes -= sizeof(HashTableBucket);
+                usage.tombstoneBytes += sizeof(HashTableBucket) + bucket.keyHeapBytes();
+            } else if (bucket.isEmpty()) {
+                usage.overheadBytes += bucket.keyHeapBytes();
+            } else {
+                usage.keyHeapBytes += bucket.keyHeapBytes();
+            }
+        }
+    }
+    return usage;
+}
+
+/* Purpose: Shrinks the table to the least memory that holds its entries.
+ * Behavior:
+ *    Rehashes into the smallest capacity at load factor 0.5, or twice
+ *    maxEntries() in bounded cache mode, dropping tombstones and expired
+ *    entries. Every key is then trimmed to its length, so storage left by
+ *    removed or replaced keys goes back to the resource. The next insert
+ *    into a compacted table may resize it.
+ */
+void HashTable::compact() {
+    rebuild(std::max({2 * m_size, 2 * m_maxEntries, size_t{2}}));
+    for (size_t i = 0; i < m_capacity; i++) {
+        if (!bucketAt(i).isEmpty()) mutableBucketAt(i).shrinkKey();
+    }
+}
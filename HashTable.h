@@ -2,50 +2,400 @@
  * HashTable.h
  */
 #pragma once
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <memory>
+#include <memory_resource>
 #include <vector>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
+#include "AsyncLookup.h"
+#include "BloomFilter.h"
 #include "HashTableBucket.h"
+#include "ParallelChunks.h"
+
+class FrozenHashTable;
 
 class HashTable {
+    public:
+        // counters kept by lookup() and the bounded cache mode
+        struct CacheStats {
+            size_t hits = 0;
+            size_t misses = 0;
+            size_t evictions = 0; // entries pushed out by the CLOCK sweep
+            size_t expirations = 0; // entries dropped because their TTL ran out
+        };
+
+        // bytes the table holds from its memory resource, by what they are for
+        struct MemoryUsage {
+            size_t slotBytes = 0; // buckets holding an entry or never used
+            size_t keyHeapBytes = 0; // storage of live keys too long for the short-string buffer
+            size_t tombstoneBytes = 0; // EAR buckets plus the key storage they still hold
+            size_t overheadBytes = 0; // page table, block epochs, shared_ptr blocks, probe offsets and Bloom filter
+
+            [[nodiscard]] size_t total() const {
+                return slotBytes + keyHeapBytes + tombstoneBytes + overheadBytes;
+            }
+        };
+
     private:
+        using BucketPage = std::pmr::vector<HashTableBucket>;
+
+        static constexpr size_t PAGE_SHIFT = 9;
+        static constexpr size_t PAGE_BUCKETS = size_t{1} << PAGE_SHIFT; // buckets per copy-on-write page
+        static constexpr size_t DIRTY_SHIFT = 3;
+        static constexpr size_t DIRTY_BUCKETS = size_t{1} << DIRTY_SHIFT; // buckets per dirty-tracking block
+
         size_t m_capacity; // the amount of spaces for buckets in the table
         size_t m_size; // the amount of buckets in the table
-        std::vector<HashTableBucket> table; // a vector that holds buckets
-        std::vector<size_t> offsets; // pseudo-random probe offsets
+        std::pmr::vector<std::shared_ptr<BucketPage>> pages; // the buckets, in pages shared with snapshots
+        std::pmr::vector<uint64_t> blockEpochs; // epoch of the last write to each DIRTY_BUCKETS-bucket block
+        std::shared_ptr<const std::pmr::vector<size_t>> offsets; // pseudo-random probe offsets, fixed per capacity
+        std::optional<BloomFilter> filter; // optional front-end that rejects most missing keys
+        size_t m_filterBitsPerKey = 0; // density of filter, kept across rebuilds
+        size_t m_tombstones = 0; // EAR buckets since the last rebuild
+        size_t m_maxEntries = 0; // entry limit in bounded cache mode, 0 if unbounded
+        size_t m_clockHand = 0; // next bucket the CLOCK sweep examines
+        CacheStats m_stats;
+        uint64_t m_epoch = 1; // epoch writes are stamped with; checkpoint() starts the next one
+        uint64_t m_replicaEpoch = 0; // epoch the last applyDelta() brought this table up to, 0 if none
+        bool m_rehashOnResize = false; // rebuild() hashes every key again instead of reading its cached hash
+
+        // outcome of one walk along a key's probe sequence
+        struct ProbeResult {
+            size_t index; // bucket holding the key, else first reusable bucket (NO_BUCKET if none)
+            bool found; // true if the key is stored at index
+        };
+
+        static constexpr size_t NO_BUCKET = static_cast<size_t>(-1);
 
         void resize();
 
+        void rebuild(size_t newCapacity);
+
+        void evictOne();
+
+        void eraseAt(size_t index, bool checkFilter = true);
+
+        void finishSweep();
+
+        [[nodiscard]] bool isExpired(size_t index) const;
+
+        /* Purpose: Calls fn(key, value) for each live entry of one page.
+         */
+        template <typename Fn>
+        void forEachInPage(const size_t page, const std::chrono::steady_clock::time_point now, Fn& fn) const {
+            for (const HashTableBucket& bucket : *pages[page]) {
+                if (!bucket.isEmpty() && !bucket.isExpired(now)) fn(bucket.getKeyView(), bucket.getValue());
+            }
+        }
+
+        void allocatePages();
+
+        [[nodiscard]] const HashTableBucket& bucketAt(size_t index) const;
+
+        HashTableBucket& mutableBucketAt(size_t index);
+
+        [[nodiscard]] ProbeResult probe(std::string_view key, uint64_t keyHash, bool mayExist = true) const;
+
+        void rebuildFilter();
+
+        std::pair<size_t, bool> findOrInsertSlot(const std::string& key, int value);
+
+        bool insertMoved(std::pmr::string&& key, int value);
+
+        std::pair<size_t, bool> findOrClaimSlot(std::string_view key, uint64_t keyHash, size_t hint = NO_BUCKET);
+
+        [[nodiscard]] size_t locate(std::string_view key, uint64_t keyHash, size_t hint) const;
+
+        size_t sweepAgainst(const HashTable& other, bool keepShared);
+
         void generateOffsets(size_t seed = 0);
 
-        [[nodiscard]] int hash(const std::string& key) const;
+        [[nodiscard]] size_t homeIndex(uint64_t keyHash) const;
 
-        [[nodiscard]] bool isNormalKeyFound(const std::string& key, size_t index) const;
+        [[nodiscard]] bool isNormalKeyFound(std::string_view key, uint64_t keyHash, size_t index) const;
 
     public:
+        using allocator_type = std::pmr::polymorphic_allocator<HashTableBucket>;
+
         static constexpr size_t DEFAULT_INITIAL_CAPACITY = 8;
 
-        HashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY); // default constructor
+        [[nodiscard]] static uint64_t hash(std::string_view key);
+
+        HashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY, const allocator_type& alloc = {}); // default constructor
+        explicit HashTable(const allocator_type& alloc);
+        HashTable(const HashTable& other);
+        HashTable(const HashTable& other, const allocator_type& alloc);
+        HashTable(HashTable&& other) noexcept;
+        HashTable& operator=(const HashTable& other);
+        HashTable& operator=(HashTable&& other) noexcept;
+
+        void swap(HashTable& other) noexcept;
+
+        friend void swap(HashTable& a, HashTable& b) noexcept {
+            a.swap(b);
+        }
+
+        void clear();
 
         bool insert(const std::string& key, int value);
 
+        /* Purpose: Inserts a pmr string key, adopting its storage (see insertMoved()).
+         * Behavior:
+         *    A template only so that string literals still pick
+         *    insert(const std::string&, int). A std::string's buffer cannot
+         *    be adopted by a memory resource, so there is no such overload
+         *    for std::string&&; emplace() avoids its temporary instead.
+         */
+        template <std::same_as<std::pmr::string> Key>
+        bool insert(Key&& key, const int value) {
+            return insertMoved(std::move(key), value);
+        }
+
+        bool emplace(std::string_view key, int value);
+
+        bool insertOrAssign(const std::string& key, int value);
+
+        std::pair<int&, bool> tryEmplace(const std::string& key, int value);
+
+        int& findOrInsert(const std::string& key, int defaultValue = 0);
+
+        /* Purpose: Applies fn to the value stored under key in a single probe.
+         * Behavior:
+         *    A missing key is inserted with value 0 first, so update(key, fn)
+         *    always stores fn(old value or 0). Returns the new value.
+         */
+        template <typename Fn>
+        int update(const std::string& key, Fn&& fn) {
+            int& value = findOrInsert(key);
+            value = fn(value);
+            return value;
+        }
+
+        int merge(const std::string& key, int delta);
+
+        /* Purpose: Adds every entry of other, combining values of shared keys.
+         * Behavior:
+         *    A key only in other is copied with its TTL; a key in both gets
+         *    combine(this value, other value). Entries are placed by the hash
+         *    stored in other's buckets, so no key is hashed again. The table
+         *    is first reserved for the larger of the two sizes, which the
+         *    union cannot be smaller than; when both tables then have the
+         *    same capacity, each of other's buckets is first matched against
+         *    the bucket at the same index, before any probing.
+         */
+        template <typename Combine>
+        void merge(const HashTable& other, Combine&& combine) {
+            if (&other != this) reserve(std::max(m_size, other.m_size));
+            const bool lockstep = other.m_capacity == m_capacity;
+            const auto now = std::chrono::steady_clock::now();
+
+            for (size_t index = 0; index < other.m_capacity; index++) {
+                const HashTableBucket& theirs = other.bucketAt(index);
+                if (theirs.isEmpty() || theirs.isExpired(now)) continue;
+                const auto [slot, claimed] = findOrClaimSlot(theirs.getKeyView(), theirs.getHash(),
+                                                             lockstep ? index : NO_BUCKET);
+                if (claimed) {
+                    mutableBucketAt(slot) = theirs;
+                } else {
+                    int& value = mutableBucketAt(slot).getValueRef();
+                    value = combine(value, theirs.getValue());
+                }
+            }
+        }
+
+        /* Purpose: Merges as merge(const HashTable&, combine), moving from other.
+         * Behavior:
+         *    Keys that are not in this table are moved, not copied. When both
+         *    tables use the same memory resource, their storage is taken over
+         *    rather than reallocated. other is left empty.
+         */
+        template <typename Combine>
+        void merge(HashTable&& other, Combine&& combine) {
+            if (&other == this) return merge(static_cast<const HashTable&>(other), combine);
+            reserve(std::max(m_size, other.m_size));
+            const bool lockstep = other.m_capacity == m_capacity;
+            const auto now = std::chrono::steady_clock::now();
+
+            for (size_t index = 0; index < other.m_capacity; index++) {
+                const HashTableBucket& theirs = other.bucketAt(index);
+                if (theirs.isEmpty() || theirs.isExpired(now)) continue;
+                const auto [slot, claimed] = findOrClaimSlot(theirs.getKeyView(), theirs.getHash(),
+                                                             lockstep ? index : NO_BUCKET);
+                if (claimed) {
+                    mutableBucketAt(slot) = std::move(other.mutableBucketAt(index));
+                } else {
+                    int& value = mutableBucketAt(slot).getValueRef();
+                    value = combine(value, theirs.getValue());
+                }
+            }
+            other = HashTable(DEFAULT_INITIAL_CAPACITY, other.getAllocator());
+        }
+
+        size_t intersect(const HashTable& other);
+
+        size_t difference(const HashTable& other);
+
+        void reserve(size_t entries);
+
+        bool insertWithTtl(const std::string& key, int value, std::chrono::steady_clock::duration ttl);
+
+        std::optional<int> lookup(const std::string& key);
+
         bool remove(const std::string& key);
 
+        size_t removeMany(std::span<const std::string> keys);
+
+        /* Purpose: Removes every entry for which pred(key, value) is true.
+         * Behavior:
+         *    Sweeps the buckets once in index order instead of hashing and
+         *    probing per key; key is a string_view into the bucket. Expired
+         *    entries met on the way are dropped without calling pred. Only
+         *    pages holding a removed entry are copied away from snapshots.
+         *    Ends with finishSweep(), which compacts the table once
+         *    tombstones fill a quarter of it. Returns the entries removed.
+         */
+        template <typename Pred>
+        size_t eraseIf(Pred&& pred) {
+            const auto now = std::chrono::steady_clock::now();
+            const size_t before = m_size;
+            size_t expired = 0;
+
+            for (size_t index = 0; index < m_capacity; index++) {
+                const HashTableBucket& bucket = bucketAt(index);
+                if (bucket.isEmpty()) continue;
+                if (bucket.isExpired(now)) {
+                    expired++;
+                } else if (!pred(bucket.getKeyView(), bucket.getValue())) {
+                    continue;
+                }
+                eraseAt(index, false);
+            }
+            m_stats.expirations += expired;
+            finishSweep();
+            return before - m_size - expired;
+        }
+
+        /* Purpose: Keeps only the entries for which pred(key, value) is true.
+         * Behavior:
+         *    eraseIf() with the predicate negated. Returns the entries removed.
+         */
+        template <typename Pred>
+        size_t retain(Pred&& pred) {
+            return eraseIf([&pred](const std::string_view key, const int value) { return !pred(key, value); });
+        }
+
         [[nodiscard]] bool contains(const std::string& key) const;
 
         [[nodiscard]] std::optional<int> get(const std::string& key) const;
 
+        [[nodiscard]] GetTask asyncGet(std::string_view key) const;
+
+        [[nodiscard]] std::vector<std::optional<int>> getMany(const std::vector<std::string>& keys,
+                                                              size_t groupSize = 8) const;
+
         [[nodiscard]] std::vector<std::string> keys() const;
 
+        [[nodiscard]] std::vector<std::string> keys(size_t threads) const;
+
+        /* Purpose: Calls fn(key, value) for every live entry, on several threads.
+         * Behavior:
+         *    Each bucket page (PAGE_BUCKETS buckets in one allocation) is a
+         *    chunk for parallelChunks()' work-stealing scheduler. fn runs
+         *    concurrently and in no particular order, so it must be
+         *    thread-safe; key is a string_view into the bucket. The table
+         *    must not be modified during the call. threads = 0 uses every
+         *    hardware thread.
+         */
+        template <typename Fn>
+        void parallelForEach(Fn&& fn, const size_t threads = 0) const {
+            const auto now = std::chrono::steady_clock::now();
+            parallelChunks(pages.size(), threads, [&](const size_t page, size_t) { forEachInPage(page, now, fn); });
+        }
+
+        /* Purpose: Folds map(key, value) over every live entry with combine, in parallel.
+         * Behavior:
+         *    Each worker folds its chunks into a private partial result; the
+         *    partials are then folded into init on the calling thread. combine
+         *    must be associative and commutative, as for std::reduce, since
+         *    the grouping depends on scheduling.
+         */
+        template <typename T, typename Map, typename Combine>
+        T parallelReduce(T init, Map&& map, Combine&& combine, const size_t threads = 0) const {
+            struct alignas(64) Partial {
+                std::optional<T> value; // padded so workers do not share a cache line
+            };
+            std::vector<Partial> partials(resolveThreads(threads));
+            const auto now = std::chrono::steady_clock::now();
+
+            parallelChunks(pages.size(), threads, [&](const size_t page, const size_t worker) {
+                std::optional<T>& partial = partials[worker].value;
+                const auto fold = [&](const std::string_view key, const int value) {
+                    partial = partial ? combine(std::move(*partial), map(key, value)) : T(map(key, value));
+                };
+                forEachInPage(page, now, fold);
+            });
+
+            for (Partial& partial : partials) {
+                if (partial.value) init = combine(std::move(init), std::move(*partial.value));
+            }
+            return init;
+        }
+
         [[nodiscard]] double alpha() const;
 
         [[nodiscard]] size_t capacity() const;
 
         [[nodiscard]] size_t size() const;
 
+        [[nodiscard]] allocator_type getAllocator() const;
+
+        [[nodiscard]] std::pmr::memory_resource* resource() const;
+
         int& operator[](const std::string& key);
 
         friend std::ostream& operator<<(std::ostream& os, const HashTable& hashTable);
 
         [[nodiscard]] std::string printMe() const;
+
+        [[nodiscard]] FrozenHashTable freeze(size_t threads = 0) const;
+
+        [[nodiscard]] HashTable snapshot() const;
+
+        [[nodiscard]] size_t sharedPages() const;
+
+        void setRehashOnResize(bool rehash);
+
+        [[nodiscard]] BucketType bucketType(size_t index) const;
+
+        [[nodiscard]] std::vector<size_t> probePath(std::string_view key) const;
+
+        uint64_t checkpoint();
+
+        [[nodiscard]] std::string exportDelta(uint64_t sinceEpoch) const;
+
+        void applyDelta(std::string_view delta);
+
+        void enableFilter(size_t bitsPerKey = 10);
+
+        void disableFilter();
+
+        [[nodiscard]] const BloomFilter* getFilter() const;
+
+        void enableEviction(size_t maxEntries);
+
+        void disableEviction();
+
+        [[nodiscard]] size_t maxEntries() const;
+
+        [[nodiscard]] CacheStats cacheStats() const;
+
+        [[nodiscard]] MemoryUsage memoryUsage() const;
+
+        void compact();
 };
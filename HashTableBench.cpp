@@ -0,0 +1,1056 @@
+/**
+ * HashTableBench.cpp
+ *
+ * Micro-benchmarks for HashTable and its companion tables. Each benchmark is
+ * a block guarded by its own #define, like the test harness. Build in
+ * Release mode; pass a scale factor as the first argument to grow or shrink
+ * every workload (default 1).
+ */
+#include "ConcurrentCounterTable.h"
+#include "ConcurrentHashTable.h"
+#include "CuckooHashTable.h"
+#include "FrozenHashTable.h"
+#include "HashTable.h"
+#include "HugePageResource.h"
+#include "IntHashTable.h"
+#include "KeyCompare.h"
+#include "KeyHash.h"
+#include "OrderedHashTable.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#define OUTSTREAM cout
+
+#define BENCH_PMR_MONOTONIC
+#define BENCH_HUGE_PAGES
+#define BENCH_WORD_COUNT
+#define BENCH_CONCURRENT_WORD_COUNT
+#define BENCH_CUCKOO_HIGH_LOAD
+#define BENCH_FROZEN
+#define BENCH_BLOOM_MISSES
+#define BENCH_SNAPSHOT
+#define BENCH_BOUNDED_CACHE
+#define BENCH_KEY_COMPARE
+#define BENCH_KEY_HASH
+#define BENCH_PARALLEL_SCAN
+#define BENCH_ASYNC_GET
+#define BENCH_RESIZE_CACHED_HASH
+#define BENCH_BULK_ERASE
+#define BENCH_SET_OPERATIONS
+#define BENCH_INT_KEYS
+#define BENCH_HOT_KEY_ACCESSORS
+#define BENCH_DELTA_REPLICATION
+#define BENCH_ORDERED
+#define BENCH_TINY_TABLES
+
+/* Purpose: Runs a callable and measures its wall-clock duration.
+ * Parameters:
+ *    fn – work to time
+ * Returns:
+ *    double – elapsed milliseconds
+ */
+template <typename Fn>
+double timeMs(Fn&& fn) {
+    const auto start = chrono::steady_clock::now();
+    fn();
+    const auto stop = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(stop - start).count();
+}
+
+/* Purpose: Prints one aligned result row.
+ */
+void report(const string& name, const double ms, const size_t operations) {
+    OUTSTREAM << "  " << left << setw(44) << name << right << setw(10) << fixed << setprecision(2) << ms << " ms"
+            << setw(12) << setprecision(1) << (operations / ms / 1000.0) << " Mops/s" << endl;
+}
+
+/* Purpose: Builds a synthetic text corpus with Zipf-distributed words.
+ * Parameters:
+ *    words – number of words in the corpus
+ *    vocabulary – number of distinct words
+ *    seed – random seed
+ * Returns:
+ *    vector<string> – the corpus, one word per element
+ */
+vector<string> zipfCorpus(const size_t words, const size_t vocabulary, const unsigned seed) {
+    vector<string> dictionary;
+    vector<double> weights;
+    for (size_t i = 0; i < vocabulary; i++) {
+        dictionary.push_back("w" + to_string(i * 2654435761u % 1000003u));
+        weights.push_back(1.0 / static_cast<double>(i + 1));
+    }
+
+    mt19937 rng(seed);
+    discrete_distribution<size_t> pick(weights.begin(), weights.end());
+    vector<string> corpus;
+    corpus.reserve(words);
+    for (size_t i = 0; i < words; i++) {
+        corpus.push_back(dictionary[pick(rng)]);
+    }
+    return corpus;
+}
+
+volatile long long benchSink = 0;
+
+/* Purpose: Keeps the optimizer from discarding a computed value.
+ * Parameters:
+ *    value – result to fold into benchSink
+ * Behavior:
+ *    A plain read and store of the volatile, since compound assignment
+ *    to a volatile is deprecated in C++20.
+ */
+void sink(const long long value) {
+    benchSink = benchSink + value;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t scale = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1;
+
+    OUTSTREAM << "+======================+" << endl;
+    OUTSTREAM << "| HASH TABLE BENCHMARK |" << endl;
+    OUTSTREAM << "+======================+" << endl << endl;
+
+    // BENCH: PER-REQUEST TABLES IN A MONOTONIC ARENA
+#ifdef BENCH_PMR_MONOTONIC
+    {
+        const size_t tables = 2000 * scale;
+        const size_t keysPerTable = 64;
+        OUTSTREAM << "Building " << tables << " short-lived tables of " << keysPerTable << " keys" << endl;
+        OUTSTREAM << "------------------------------------------------------" << endl;
+
+        vector<string> keys;
+        for (size_t i = 0; i < keysPerTable; i++) {
+            keys.push_back("session-attribute-" + to_string(i * 7919));
+        }
+
+        const double globalMs = timeMs([&] {
+            for (size_t t = 0; t < tables; t++) {
+                HashTable ht;
+                for (size_t i = 0; i < keysPerTable; i++) ht.insert(keys[i], static_cast<int>(i));
+                sink(ht.size());
+            }
+        });
+        report("global allocator", globalMs, tables * keysPerTable);
+
+        std::pmr::unsynchronized_pool_resource pool;
+        const double poolMs = timeMs([&] {
+            for (size_t t = 0; t < tables; t++) {
+                HashTable ht(HashTable::DEFAULT_INITIAL_CAPACITY, &pool);
+                for (size_t i = 0; i < keysPerTable; i++) ht.insert(keys[i], static_cast<int>(i));
+                sink(ht.size());
+            }
+        });
+        report("unsynchronized_pool_resource", poolMs, tables * keysPerTable);
+
+        vector<std::byte> buffer(1 << 20);
+        const double arenaMs = timeMs([&] {
+            for (size_t t = 0; t < tables; t++) {
+                // per-request arena: everything is freed at once when it goes out of scope
+                std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+                HashTable ht(HashTable::DEFAULT_INITIAL_CAPACITY, &arena);
+                for (size_t i = 0; i < keysPerTable; i++) ht.insert(keys[i], static_cast<int>(i));
+                sink(ht.size());
+            }
+        });
+        report("monotonic_buffer_resource (stack buffer)", arenaMs, tables * keysPerTable);
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: RANDOM LOOKUPS ON 4KB VERSUS 2MB PAGES
+#ifdef BENCH_HUGE_PAGES
+    {
+        // fixed-width keys; the additive hash clusters them, so keep the default size small
+        const size_t count = (1 << 14) * scale;
+        const size_t lookups = 200000;
+        OUTSTREAM << "Random get() over " << count << " keys, " << lookups << " lookups" << endl;
+        OUTSTREAM << "------------------------------------------------------" << endl;
+
+        vector<string> keys;
+        for (size_t i = 0; i < count; i++) {
+            keys.push_back("k" + string(9 - to_string(i).size(), '0') + to_string(i));
+        }
+        vector<size_t> order(lookups);
+        mt19937_64 rng(42);
+        for (size_t& i : order) i = rng() % count;
+
+        const HugePageMode modes[] = {HugePageMode::NONE, HugePageMode::TRANSPARENT, HugePageMode::EXPLICIT};
+        const char* names[] = {"4KB pages", "transparent 2MB pages", "explicit 2MB pages (MAP_HUGETLB)"};
+        for (int m = 0; m < 3; m++) {
+            HugePageResource pages(modes[m], NumaPolicy::DEFAULT, 0, 64 * 1024);
+            HashTable ht(count * 4, &pages);
+            for (size_t i = 0; i < count; i++) ht.insert(keys[i], static_cast<int>(i));
+
+            const double ms = timeMs([&] {
+                long long sum = 0;
+                for (const size_t i : order) sum += ht.get(keys[i]).value_or(0);
+                sink(sum);
+            });
+            report(names[m], ms, lookups);
+            if (modes[m] == HugePageMode::EXPLICIT && pages.fallbackMappings() > 0)
+                OUTSTREAM << "    (no reserved huge pages; fell back to transparent)" << endl;
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: WORD COUNT, MULTI-PROBE VERSUS SINGLE-PROBE UPSERT
+#ifdef BENCH_WORD_COUNT
+    {
+        const size_t words = 200000 * scale;
+        const vector<string> corpus = zipfCorpus(words, 20000, 7);
+        OUTSTREAM << "Word count over " << words << " Zipf words (20000 distinct)" << endl;
+        OUTSTREAM << "------------------------------------------------------" << endl;
+
+        const double twoProbeMs = timeMs([&] {
+            HashTable ht;
+            for (const string& w : corpus) {
+                if (!ht.insert(w, 1)) ht[w]++; // insert() probe + operator[] probe
+            }
+            sink(ht.size());
+        });
+        report("insert() then operator[]", twoProbeMs, words);
+
+        const double containsMs = timeMs([&] {
+            HashTable ht;
+            for (const string& w : corpus) {
+                if (ht.contains(w)) ht[w]++; // contains() probe + operator[] probe
+                else ht.insert(w, 1);
+            }
+            sink(ht.size());
+        });
+        report("contains() then insert()/operator[]", containsMs, words);
+
+        const double mergeMs = timeMs([&] {
+            HashTable ht;
+            for (const string& w : corpus) ht.merge(w, 1);
+            sink(ht.size());
+        });
+        report("merge(key, 1)", mergeMs, words);
+
+        const double bracketMs = timeMs([&] {
+            HashTable ht;
+            for (const string& w : corpus) ht[w]++;
+            sink(ht.size());
+        });
+        report("operator[]++ (inserts missing keys)", bracketMs, words);
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: MULTI-THREADED WORD FREQUENCY
+#ifdef BENCH_CONCURRENT_WORD_COUNT
+    {
+        const size_t words = 500000 * scale;
+        const size_t vocabulary = 50000;
+        const vector<string> corpus = zipfCorpus(words, vocabulary, 11);
+        OUTSTREAM << "Multi-threaded word frequency over " << words << " Zipf words" << endl;
+        OUTSTREAM << "------------------------------------------------------" << endl;
+
+        // runs body(begin, end) on each thread's share of the corpus
+        auto runThreads = [&](const size_t threads, auto body) {
+            vector<thread> workers;
+            for (size_t t = 0; t < threads; t++) {
+                workers.emplace_back([&, t] { body(words * t / threads, words * (t + 1) / threads); });
+            }
+            for (thread& worker : workers) worker.join();
+        };
+
+        for (const size_t threads : {1, 2, 4, 8}) {
+            OUTSTREAM << "  " << threads << " thread(s)" << endl;
+
+            const double mutexMs = timeMs([&] {
+                HashTable ht;
+                mutex lock;
+                runThreads(threads, [&](const size_t begin, const size_t end) {
+                    for (size_t i = begin; i < end; i++) {
+                        lock_guard<mutex> guard(lock);
+                        ht[corpus[i]]++;
+                    }
+                });
+                sink(ht.size());
+            });
+            report("  mutex + HashTable::operator[]++", mutexMs, words);
+
+            const double atomicMs = timeMs([&] {
+                ConcurrentCounterTable counts(vocabulary);
+                runThreads(threads, [&](const size_t begin, const size_t end) {
+                    for (size_t i = begin; i < end; i++) counts.increment(corpus[i]);
+                });
+                sink(counts.size());
+            });
+            report("  ConcurrentCounterTable::increment", atomicMs, words);
+
+            const double bufferedMs = timeMs([&] {
+                ConcurrentCounterTable counts(vocabulary);
+                runThreads(threads, [&](const size_t begin, const size_t end) {
+                    ConcurrentCounterTable::LocalBuffer buffer(counts);
+                    for (size_t i = begin; i < end; i++) buffer.add(corpus[i]);
+                });
+                sink(counts.size());
+            });
+            report("  ConcurrentCounterTable + LocalBuffer", bufferedMs, words);
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: CUCKOO LOOKUPS AT 90%+ LOAD
+#ifdef BENCH_CUCKOO_HIGH_LOAD
+    {
+        const size_t slots = (1 << 16) * scale;
+        const size_t lookups = 1000000;
+        OUTSTREAM << "CuckooHashTable get() with " << slots << " slots, " << lookups << " lookups" << endl;
+        OUTSTREAM << "------------------------------------------------------" << endl;
+
+        mt19937_64 rng(5);
+        vector<string> keys;
+        for (size_t i = 0; i < slots; i++) keys.push_back("user:" + to_string(rng()));
+        vector<string> missing;
+        for (size_t i = 0; i < 4096; i++) missing.push_back("absent:" + to_string(rng()));
+
+        for (const double load : {0.5, 0.9, 0.95}) {
+            CuckooHashTable ht(slots);
+            const size_t count = static_cast<size_t>(load * static_cast<double>(slots));
+            for (size_t i = 0; i < count; i++) ht.insert(keys[i], static_cast<int>(i));
+
+            const double hitMs = timeMs([&] {
+                long long sum = 0;
+                for (size_t i = 0; i < lookups; i++) sum += ht.get(keys[(i * 7919) % count]).value_or(0);
+                sink(sum);
+            });
+            const double missMs = timeMs([&] {
+                size_t found = 0;
+                for (size_t i = 0; i < lookups; i++) found += ht.contains(missing[i % missing.size()]);
+                sink(found);
+            });
+            OUTSTREAM << "  load " << setprecision(3) << ht.alpha() << " (stash " << ht.stashSize() << ", capacity " << ht.capacity()
+                    << ")" << endl;
+            report("  cuckoo get() hit", hitMs, lookups);
+            report("  cuckoo contains() miss", missMs, lookups);
+        }
+
+        // the mutable HashTable never runs above 50% load
+        HashTable ht(slots);
+        const size_t count = slots / 2 - 1;
+        for (size_t i = 0; i < count; i++) ht.insert(keys[i], static_cast<int>(i));
+        const double hitMs = timeMs([&] {
+            long long sum = 0;
+            for (size_t i = 0; i < lookups; i++) sum += ht.get(keys[(i * 7919) % count]).value_or(0);
+            sink(sum);
+        });
+        const double missMs = timeMs([&] {
+            size_t found = 0;
+            for (size_t i = 0; i < lookups; i++) found += ht.contains(missing[i % missing.size()]);
+            sink(found);
+        });
+        OUTSTREAM << "  HashTable at load " << setprecision(3) << ht.alpha() << endl;
+        report("  HashTable get() hit", hitMs, lookups);
+        report("  HashTable contains() miss", missMs, lookups);
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: FROZEN VERSUS MUTABLE TABLE
+#ifdef BENCH_FROZEN
+    {
+        const size_t count = 50000 * scale;
+        const size_t lookups = 200000;
+        OUTSTREAM << "FrozenHashTable versus HashTable with " << count << " keys" << endl;
+        OUTSTREAM << "------------------------------------------------------" << endl;
+
+        mt19937_64 rng(9);
+        vector<string> keys;
+        for (size_t i = 0; i < count; i++) keys.push_back("sku-" + to_string(rng() % 100000000000ULL));
+        HashTable ht;
+        for (size_t i = 0; i < count; i++) ht.insert(keys[i], static_cast<int>(i));
+
+        for (const size_t threads : {1, 4}) {
+            size_t bytes = 0;
+            const double buildMs = timeMs([&] { bytes = ht.freeze(threads).bytes(); });
+            report("freeze() with " + to_string(threads) + " thread(s)", buildMs, count);
+            sink(bytes);
+        }
+        const FrozenHashTable frozen = ht.freeze();
+
+        const double mutableMs = timeMs([&] {
+            long long sum = 0;
+            for (size_t i = 0; i < lookups; i++) sum += ht.get(keys[(i * 7919) % count]).value_or(0);
+            sink(sum);
+        });
+        report("HashTable get()", mutableMs, lookups);
+        const double frozenMs = timeMs([&] {
+            long long sum = 0;
+            for (size_t i = 0; i < lookups; i++) sum += frozen.get(keys[(i * 7919) % count]).value_or(0);
+            sink(sum);
+        });
+        report("FrozenHashTable get()", frozenMs, lookups);
+
+        // bucket array and offsets, plus heap storage for keys too long for the small-string buffer
+        size_t mutableBytes = ht.capacity() * (sizeof(HashTableBucket) + sizeof(size_t));
+        for (const string& key : keys) mutableBytes += key.size() > 15 ? key.size() + 1 : 0;
+        OUTSTREAM << "  HashTable bytes (approx.): " << mutableBytes << ", FrozenHashTable bytes: " << frozen.bytes()
+                << endl << endl;
+    }
+#endif
+
+    // BENCH: MISS PATH WITH AND WITHOUT THE BLOOM FILTER
+#ifdef BENCH_BLOOM_MISSES
+    {
+        const size_t count = 20000 * scale;
+        const size_t lookups = 500000;
+        OUTSTREAM << "contains() misses over " << count << " keys with half of them removed" << endl;
+        OUTSTREAM << "------------------------------------------------------" << endl;
+
+        vector<string> keys, missing;
+        for (size_t i = 0; i < count; i++) keys.push_back("present-" + to_string(i));
+        for (size_t i = 0; i < 8192; i++) missing.push_back("missing-" + to_string(i));
+
+        for (const size_t bitsPerKey : {0, 8, 10, 16}) {
+            HashTable ht;
+            if (bitsPerKey > 0) ht.enableFilter(bitsPerKey);
+            for (size_t i = 0; i < count; i++) ht.insert(keys[i], static_cast<int>(i));
+            for (size_t i = 0; i < count; i += 2) ht.remove(keys[i]); // leave EAR tombstones
+
+            size_t found = 0;
+            const double ms = timeMs([&] {
+                for (size_t i = 0; i < lookups; i++) found += ht.contains(missing[i % missing.size()]);
+            });
+            sink(found);
+
+            if (bitsPerKey == 0) {
+                report("no filter", ms, lookups);
+                continue;
+            }
+            size_t falsePositives = 0;
+            for (const string& key : missing) falsePositives += ht.getFilter()->mayContain(HashTable::hash(key));
+            report(to_string(bitsPerKey) + " bits/key blocked Bloom filter", ms, lookups);
+            OUTSTREAM << "    false-positive rate " << setprecision(4)
+                    << 100.0 * static_cast<double>(falsePositives) / static_cast<double>(missing.size())
+                    << "% (estimate " << 100.0 * ht.getFilter()->expectedFalsePositiveRate() << "%), "
+                    << ht.getFilter()->bytes() << " filter bytes" << endl;
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: WRITES UNDER A LIVE COPY-ON-WRITE SNAPSHOT
+#ifdef BENCH_SNAPSHOT
+    {
+        const size_t count = 20000 * scale;
+        const size_t updates = 50000;
+        OUTSTREAM << "merge() updates over " << count << " keys, with a reader scanning a snapshot" << endl;
+        OUTSTREAM << "-----------------------------------------------------------------" << endl;
+
+        vector<string> keys;
+        for (size_t i = 0; i < count; i++) keys.push_back("key-" + to_string(i));
+
+        for (const bool withSnapshot : {false, true}) {
+            HashTable ht;
+            for (size_t i = 0; i < count; i++) ht.insert(keys[i], 0);
+
+            atomic<bool> done{false};
+            size_t scans = 0;
+            thread reader;
+            if (withSnapshot) {
+                // the snapshot is taken before the writer starts; the reader never locks
+                reader = thread([&done, &scans, view = ht.snapshot()] {
+                    while (!done.load(memory_order_relaxed)) {
+                        sink(view.keys().size());
+                        scans++;
+                    }
+                });
+            }
+
+            const size_t sharedBefore = ht.sharedPages();
+            const double ms = timeMs([&] {
+                for (size_t i = 0; i < updates; i++) ht.merge(keys[(i * 7919) % count], 1);
+            });
+            const size_t copiedPages = sharedBefore - ht.sharedPages();
+            done = true;
+            if (reader.joinable()) reader.join();
+
+            report(withSnapshot ? "writer with a live snapshot" : "writer alone", ms, updates);
+            if (withSnapshot) {
+                OUTSTREAM << "    " << copiedPages << " of " << sharedBefore << " pages copied ("
+                        << copiedPages * 512 * sizeof(HashTableBucket) << " extra bytes), " << scans
+                        << " reader scans" << endl;
+            }
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: BOUNDED CACHE HIT RATIO ON A ZIPFIAN TRACE
+#ifdef BENCH_BOUNDED_CACHE
+    {
+        const size_t requests = 200000 * scale;
+        const size_t vocabulary = 50000;
+        OUTSTREAM << "Cache over a " << requests << "-request Zipfian trace (" << vocabulary << " distinct keys)" << endl;
+        OUTSTREAM << "---------------------------------------------------------------------" << endl;
+        const vector<string> trace = zipfCorpus(requests, vocabulary, 11);
+
+        for (const size_t cacheSize : {500, 5000}) {
+            // reference LRU: recency list plus an index into it
+            size_t lruHits = 0;
+            const double lruMs = timeMs([&] {
+                list<pair<string, int>> recency;
+                unordered_map<string, list<pair<string, int>>::iterator> index;
+                for (size_t i = 0; i < trace.size(); i++) {
+                    const auto it = index.find(trace[i]);
+                    if (it != index.end()) {
+                        recency.splice(recency.begin(), recency, it->second);
+                        lruHits++;
+                        continue;
+                    }
+                    if (index.size() == cacheSize) {
+                        index.erase(recency.back().first);
+                        recency.pop_back();
+                    }
+                    recency.emplace_front(trace[i], static_cast<int>(i));
+                    index.emplace(trace[i], recency.begin());
+                }
+            });
+
+            HashTable cache;
+            cache.enableEviction(cacheSize);
+            const double clockMs = timeMs([&] {
+                for (size_t i = 0; i < trace.size(); i++) {
+                    if (!cache.lookup(trace[i])) cache.insert(trace[i], static_cast<int>(i)); // miss: fill from "backing store"
+                }
+            });
+            const HashTable::CacheStats stats = cache.cacheStats();
+
+            OUTSTREAM << "  " << cacheSize << " entries:" << endl;
+            report("  list + unordered_map LRU", lruMs, requests);
+            report("  HashTable CLOCK", clockMs, requests);
+            OUTSTREAM << "    hit ratio LRU " << setprecision(2)
+                    << 100.0 * static_cast<double>(lruHits) / static_cast<double>(requests) << "%, CLOCK "
+                    << 100.0 * static_cast<double>(stats.hits) / static_cast<double>(requests) << "% ("
+                    << stats.evictions << " evictions)" << endl;
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: KEY COMPARISON KERNELS BY KEY LENGTH
+#ifdef BENCH_KEY_COMPARE
+    {
+        const size_t compares = 2000000 * scale;
+        OUTSTREAM << "Equal-key compares by key length (active kernel: "
+                << cpuLevelName(dispatchLevel()) << ")" << endl;
+        OUTSTREAM << "--------------------------------------------------------" << endl;
+
+        for (const size_t length : {8, 16, 32, 64, 128, 256, 512}) {
+            // equal keys are the worst case: every byte has to be read
+            vector<string> left, right;
+            for (size_t i = 0; i < 64; i++) {
+                left.push_back(string(length, static_cast<char>('a' + i % 26)));
+                right.push_back(left.back());
+            }
+
+            OUTSTREAM << "  " << length << "-byte keys:" << endl;
+            const double stringMs = timeMs([&] {
+                size_t equal = 0;
+                for (size_t i = 0; i < compares; i++) equal += left[i % 64] == right[i % 64];
+                sink(equal);
+            });
+            report("  std::string operator==", stringMs, compares);
+
+            for (const CpuLevel level : ALL_CPU_LEVELS) {
+                if (!cpuLevelSupported(level) || level == CpuLevel::SSE42) continue; // SSE4.2 reuses the SSE2 kernel
+                const KeyCompareFn compare = keyCompareKernel(level);
+                const double ms = timeMs([&] {
+                    size_t equal = 0;
+                    for (size_t i = 0; i < compares; i++) {
+                        equal += compare(left[i % 64].data(), right[i % 64].data(), length);
+                    }
+                    sink(equal);
+                });
+                report(string("  ") + cpuLevelName(level), ms, compares);
+            }
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: HASH KERNELS BY KEY LENGTH
+#ifdef BENCH_KEY_HASH
+    {
+        const size_t hashes = 2000000 * scale;
+        const CpuFeatures& features = cpuFeatures();
+        OUTSTREAM << "Key hashing by key length (sse2 " << features.sse2 << ", sse4.2 " << features.sse42 << ", avx2 "
+                << features.avx2 << ", avx512bw " << features.avx512bw << ", bmi2 " << features.bmi2 << ", neon "
+                << features.neon << ")" << endl;
+        OUTSTREAM << "------------------------------------------------------------------------------" << endl;
+
+        for (const size_t length : {8, 16, 32, 64, 128, 256, 512}) {
+            vector<string> keys;
+            for (size_t i = 0; i < 64; i++) keys.push_back(string(length, static_cast<char>('a' + i % 26)));
+
+            OUTSTREAM << "  " << length << "-byte keys:" << endl;
+            KeyHashFn previous = nullptr;
+            for (const CpuLevel level : ALL_CPU_LEVELS) {
+                if (!cpuLevelSupported(level) || keyHashKernel(level) == previous) continue; // skip shared kernels
+                const KeyHashFn hashFn = previous = keyHashKernel(level);
+                const double ms = timeMs([&] {
+                    uint64_t mixed = 0;
+                    for (size_t i = 0; i < hashes; i++) mixed ^= hashFn(keys[i % 64]);
+                    sink(static_cast<long long>(mixed & 1));
+                });
+                report(string("  ") + cpuLevelName(level), ms, hashes);
+            }
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: PARALLEL SCANS BY THREAD COUNT
+#ifdef BENCH_PARALLEL_SCAN
+    {
+        const size_t count = 1000000 * scale;
+        OUTSTREAM << "Scans over " << count << " entries by thread count" << endl;
+        OUTSTREAM << "------------------------------------------" << endl;
+
+        HashTable ht;
+        for (size_t i = 0; i < count; i++) ht.insert("scan-key-" + to_string(i), static_cast<int>(i));
+        OUTSTREAM << "  capacity " << ht.capacity() << " buckets" << endl;
+
+        const double serialMs = timeMs([&] { sink(static_cast<long long>(ht.keys().size())); });
+        report("keys(), serial", serialMs, ht.capacity());
+
+        for (const size_t threads : {1, 2, 4, 8, 16}) {
+            const double keysMs = timeMs([&] { sink(static_cast<long long>(ht.keys(threads).size())); });
+            report("keys(" + to_string(threads) + ")", keysMs, ht.capacity());
+
+            const double reduceMs = timeMs([&] {
+                sink(ht.parallelReduce(0LL, [](string_view, const int value) {
+                    return static_cast<long long>(value);
+                }, [](const long long a, const long long b) { return a + b; }, threads));
+            });
+            report("parallelReduce(sum, " + to_string(threads) + ")", reduceMs, ht.capacity());
+        }
+        OUTSTREAM << "  (Mops/s counts buckets scanned)" << endl << endl;
+    }
+#endif
+
+    // BENCH: INTERLEAVED COROUTINE LOOKUPS ON AN OUT-OF-CACHE TABLE
+#ifdef BENCH_ASYNC_GET
+    {
+        const size_t count = 1000000 * scale;
+        const size_t lookups = 1000000;
+        OUTSTREAM << "Random hits over " << count << " entries, get() vs interleaved getMany()" << endl;
+        OUTSTREAM << "----------------------------------------------------------------" << endl;
+
+        HashTable ht;
+        for (size_t i = 0; i < count; i++) ht.insert("async-key-" + to_string(i), static_cast<int>(i));
+        OUTSTREAM << "  bucket array about " << ht.capacity() * sizeof(HashTableBucket) / (1024 * 1024) << " MB" << endl;
+
+        mt19937 rng(5);
+        uniform_int_distribution<size_t> pick(0, count - 1);
+        vector<string> queries;
+        for (size_t i = 0; i < lookups; i++) queries.push_back("async-key-" + to_string(pick(rng)));
+
+        const double sequentialMs = timeMs([&] {
+            long long sum = 0;
+            for (const string& key : queries) sum += ht.get(key).value_or(0);
+            sink(sum);
+        });
+        report("get(), one at a time", sequentialMs, lookups);
+
+        for (const size_t groupSize : {1, 2, 4, 8, 16, 32, 64}) {
+            const double ms = timeMs([&] {
+                long long sum = 0;
+                for (const optional<int>& value : ht.getMany(queries, groupSize)) sum += value.value_or(0);
+                sink(sum);
+            });
+            report("getMany(group " + to_string(groupSize) + ")", ms, lookups);
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: RESIZE WITH HASHES CACHED IN THE BUCKETS
+#ifdef BENCH_RESIZE_CACHED_HASH
+    {
+        const size_t minCapacity = (size_t{1} << 19) * scale;
+        OUTSTREAM << "Resizing a table of 64-byte keys" << endl;
+        OUTSTREAM << "--------------------------------" << endl;
+
+        auto keyFor = [](const size_t i) {
+            string key = "resize-" + to_string(i);
+            key.resize(64, '.');
+            return key;
+        };
+        // fills a table to the point where the next insert doubles it
+        auto build = [&] {
+            HashTable ht;
+            for (size_t i = 0; ht.capacity() < minCapacity || ht.alpha() < 0.5; i++) {
+                ht.insert(keyFor(i), static_cast<int>(i));
+            }
+            return ht;
+        };
+
+        HashTable cached = build();
+        HashTable rehashed = build();
+        rehashed.setRehashOnResize(true);
+        const size_t entries = cached.size();
+        OUTSTREAM << "  " << entries << " entries, capacity " << cached.capacity() << " -> " << 2 * cached.capacity()
+                << endl;
+
+        // the next insert doubles each table; one places buckets by their stored hash, the other hashes every key
+        const double cachedMs = timeMs([&] { cached.insert(keyFor(entries), 0); });
+        report("resize, cached hashes", cachedMs, entries);
+        const double rehashedMs = timeMs([&] { rehashed.insert(keyFor(entries), 0); });
+        report("resize, rehashing every key", rehashedMs, entries);
+        sink(static_cast<long long>(cached.capacity() == rehashed.capacity()));
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: REMOVING 30% OF THE ENTRIES
+#ifdef BENCH_BULK_ERASE
+    {
+        const size_t count = 10000000 * scale;
+        OUTSTREAM << "Removing 30% of " << count << " entries" << endl;
+        OUTSTREAM << "--------------------------------------" << endl;
+
+        auto build = [count] {
+            HashTable ht;
+            for (size_t i = 0; i < count; i++) ht.insert("bulk-key-" + to_string(i), static_cast<int>(i));
+            return ht;
+        };
+        auto doomed = [](const int value) { return value % 10 < 3; };
+
+        {
+            HashTable ht = build();
+            const double ms = timeMs([&] {
+                for (const string& key : ht.keys()) {
+                    if (doomed(*ht.get(key))) ht.remove(key);
+                }
+            });
+            report("keys() + get() + remove() per key", ms, count);
+        }
+        {
+            HashTable ht = build();
+            vector<string> batch;
+            for (size_t i = 0; i < count; i++) {
+                if (doomed(static_cast<int>(i))) batch.push_back("bulk-key-" + to_string(i));
+            }
+            const double ms = timeMs([&] { sink(static_cast<long long>(ht.removeMany(batch))); });
+            report("removeMany(), keys known", ms, batch.size());
+        }
+        {
+            HashTable ht = build();
+            const double ms = timeMs([&] {
+                sink(static_cast<long long>(ht.eraseIf([&](string_view, const int value) { return doomed(value); })));
+            });
+            report("eraseIf(), one sweep", ms, count);
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: MERGING AND INTERSECTING TABLES
+#ifdef BENCH_SET_OPERATIONS
+    {
+        const size_t count = 1000000 * scale;
+        OUTSTREAM << "Merging " << count / 4 << " hourly counts into " << count << " daily counts" << endl;
+        OUTSTREAM << "------------------------------------------------------" << endl;
+
+        HashTable daily;
+        HashTable hourly;
+        for (size_t i = 0; i < count; i++) daily.insert("daily-count-" + to_string(i), 1);
+        for (size_t i = count - count / 8; i < count + count / 8; i++) hourly.insert("daily-count-" + to_string(i), 1); // half are new
+        HashTable hourlyReserved = hourly;
+        hourlyReserved.reserve(count + count / 4);
+        const auto plus = [](const int a, const int b) { return a + b; };
+
+        {
+            HashTable ht = daily;
+            const double ms = timeMs([&] {
+                for (const string& key : hourly.keys()) ht.merge(key, *hourly.get(key));
+            });
+            report("merge, keys() + get() + merge(key) loop", ms, hourly.size());
+        }
+        {
+            HashTable ht = daily;
+            const double ms = timeMs([&] { ht.merge(hourly, plus); });
+            report("merge(other), probing", ms, hourly.size());
+        }
+        {
+            HashTable ht = daily;
+            ht.reserve(count + count / 4);
+            const double ms = timeMs([&] { ht.merge(hourlyReserved, plus); });
+            report("merge(other), same capacity (lockstep)", ms, hourly.size());
+        }
+        {
+            HashTable ht = daily;
+            const double ms = timeMs([&] {
+                for (const string& key : ht.keys()) {
+                    if (!hourly.contains(key)) ht.remove(key);
+                }
+            });
+            report("intersect, keys() + contains() + remove()", ms, count);
+        }
+        {
+            HashTable ht = daily;
+            const double ms = timeMs([&] { sink(static_cast<long long>(ht.intersect(hourly))); });
+            report("intersect(other)", ms, count);
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: INTEGER KEYS VERSUS STRING KEYS
+#ifdef BENCH_INT_KEYS
+    {
+        const size_t count = 1000000 * scale;
+        OUTSTREAM << "Inserting and looking up " << count << " 64-bit IDs" << endl;
+        OUTSTREAM << "---------------------------------------------" << endl;
+
+        mt19937_64 rng(42);
+        vector<uint64_t> randomIds(count);
+        for (uint64_t& id : randomIds) id = rng();
+        vector<uint64_t> sequentialIds(count);
+        for (size_t i = 0; i < count; i++) sequentialIds[i] = 1000000000 + i;
+
+        for (const auto& [name, ids] : {pair<string, const vector<uint64_t>&>{"random", randomIds},
+                                        pair<string, const vector<uint64_t>&>{"sequential", sequentialIds}}) {
+            const double stringMs = timeMs([&] {
+                HashTable ht;
+                for (const uint64_t id : ids) ht.insert(to_string(id), 1);
+                long long found = 0;
+                for (const uint64_t id : ids) found += ht.get(to_string(id)).value_or(0);
+                sink(found);
+            });
+            report(name + " IDs, HashTable + to_string()", stringMs, 2 * count);
+
+            const double intMs = timeMs([&] {
+                IntHashTable ht;
+                for (const uint64_t id : ids) ht.insert(id, 1);
+                long long found = 0;
+                for (const uint64_t id : ids) found += ht.get(id).value_or(0);
+                sink(found);
+            });
+            report(name + " IDs, IntHashTable", intMs, 2 * count);
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: CONTENDED UPDATES TO HOT KEYS
+#ifdef BENCH_HOT_KEY_ACCESSORS
+    {
+        const size_t updates = 1000000 * scale;
+        OUTSTREAM << "Contended read-modify-write of " << updates << " values" << endl;
+        OUTSTREAM << "---------------------------------------------" << endl;
+
+        // runs body(t, count) on each thread's share of the updates
+        auto runThreads = [&](const size_t threads, auto body) {
+            vector<thread> workers;
+            for (size_t t = 0; t < threads; t++) {
+                workers.emplace_back([&, t] { body(t, updates / threads); });
+            }
+            for (thread& worker : workers) worker.join();
+        };
+
+        for (const size_t hotKeys : {1, 64}) {
+            vector<string> keys;
+            for (size_t k = 0; k < hotKeys; k++) keys.push_back("hot:" + to_string(k));
+
+            for (const size_t threads : {1, 2, 4, 8}) {
+                OUTSTREAM << "  " << hotKeys << " hot key(s), " << threads << " thread(s)" << endl;
+
+                const double mutexMs = timeMs([&] {
+                    HashTable ht;
+                    mutex lock;
+                    runThreads(threads, [&](const size_t t, const size_t count) {
+                        for (size_t i = 0; i < count; i++) {
+                            lock_guard<mutex> guard(lock);
+                            ht[keys[(i + t) % hotKeys]]++;
+                        }
+                    });
+                    sink(ht.size());
+                });
+                report("  mutex + HashTable::operator[]++", mutexMs, updates);
+
+                const double accessorMs = timeMs([&] {
+                    ConcurrentHashTable ht;
+                    runThreads(threads, [&](const size_t t, const size_t count) {
+                        ConcurrentHashTable::Accessor accessor;
+                        for (size_t i = 0; i < count; i++) {
+                            ht.insert(accessor, keys[(i + t) % hotKeys]);
+                            ++*accessor;
+                        }
+                    });
+                    sink(ht.size());
+                });
+                report("  ConcurrentHashTable::Accessor", accessorMs, updates);
+            }
+        }
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: DELTA REPLICATION AT A 1% MUTATION RATE
+#ifdef BENCH_DELTA_REPLICATION
+    {
+        const size_t count = 1000000 * scale;
+        const size_t changes = count / 100;
+        OUTSTREAM << "Replicating " << count << " entries after " << changes << " changes" << endl;
+        OUTSTREAM << "---------------------------------------------" << endl;
+
+        HashTable primary;
+        for (size_t i = 0; i < count; i++) primary.insert("user:" + to_string(i), static_cast<int>(i));
+        const uint64_t since = primary.checkpoint();
+        HashTable replica;
+        replica.applyDelta(primary.exportDelta(0));
+
+        // a third of the changes each update, remove and insert a key
+        mt19937_64 rng(47);
+        for (size_t i = 0; i < changes; i++) {
+            const string key = "user:" + to_string(rng() % count);
+            if (i % 3 == 0) {
+                primary[key]++;
+            } else if (i % 3 == 1) {
+                primary.remove(key);
+            } else {
+                primary.insert("new:" + to_string(i), 1);
+            }
+        }
+        primary.checkpoint();
+
+        string dump;
+        const double dumpMs = timeMs([&] { dump = primary.printMe(); });
+        string full;
+        const double fullMs = timeMs([&] { full = primary.exportDelta(0); });
+        string delta;
+        const double deltaMs = timeMs([&] { delta = primary.exportDelta(since); });
+        OUTSTREAM << "  printMe() " << dump.size() << " bytes, full image " << full.size() << " bytes, delta "
+                << delta.size() << " bytes" << endl;
+        report("printMe()", dumpMs, count);
+        report("exportDelta(0)", fullMs, count);
+        report("exportDelta(since)", deltaMs, changes);
+
+        const double applyFullMs = timeMs([&] {
+            HashTable copy;
+            copy.applyDelta(full);
+            sink(copy.size());
+        });
+        report("applyDelta(full image) to an empty table", applyFullMs, count);
+        const double applyDeltaMs = timeMs([&] { replica.applyDelta(delta); });
+        report("applyDelta(delta) to the replica", applyDeltaMs, changes);
+        sink(replica.size());
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: INSERTION-ORDERED DENSE ENTRIES VERSUS BUCKET ORDER
+#ifdef BENCH_ORDERED
+    {
+        const size_t count = 1000000 * scale;
+        OUTSTREAM << "Scanning and resizing " << count << " entries" << endl;
+        OUTSTREAM << "---------------------------------------------" << endl;
+
+        vector<string> keys;
+        for (size_t i = 0; i < count; i++) keys.push_back("order:" + to_string(i * 2654435761u));
+
+        HashTable table;
+        const double tableInsertMs = timeMs([&] {
+            for (size_t i = 0; i < count; i++) table.insert(keys[i], static_cast<int>(i));
+        });
+        report("HashTable insert (with resizes)", tableInsertMs, count);
+        OrderedHashTable ordered;
+        const double orderedInsertMs = timeMs([&] {
+            for (size_t i = 0; i < count; i++) ordered.insert(keys[i], static_cast<int>(i));
+        });
+        report("OrderedHashTable insert (with resizes)", orderedInsertMs, count);
+
+        const double tableScanMs = timeMs([&] {
+            long long sum = 0;
+            table.parallelForEach([&](string_view, const int value) { sum += value; }, 1);
+            sink(sum);
+        });
+        report("HashTable scan, bucket order", tableScanMs, count);
+        const double orderedScanMs = timeMs([&] {
+            long long sum = 0;
+            ordered.forEach([&](string_view, const int value) { sum += value; });
+            sink(sum);
+        });
+        report("OrderedHashTable scan, insertion order", orderedScanMs, count);
+
+        const double tableKeysMs = timeMs([&] { sink(static_cast<long long>(table.keys().size())); });
+        report("HashTable keys()", tableKeysMs, count);
+        const double orderedKeysMs = timeMs([&] { sink(static_cast<long long>(ordered.keys().size())); });
+        report("OrderedHashTable keys()", orderedKeysMs, count);
+
+        const double tableResizeMs = timeMs([&] { table.reserve(table.capacity()); });
+        report("HashTable resize to double", tableResizeMs, count);
+        const double orderedResizeMs = timeMs([&] { ordered.reserve(ordered.capacity() * 2 / 3 * 2); });
+        report("OrderedHashTable resize to double", orderedResizeMs, count);
+        OUTSTREAM << endl;
+    }
+#endif
+
+    // BENCH: MANY TINY TABLES, INLINE STORAGE VERSUS PAGED BUCKETS
+#ifdef BENCH_TINY_TABLES
+    {
+        const size_t count = 1000000 * scale;
+        const size_t keysPerTable = 4;
+        OUTSTREAM << "Building " << count << " tables of " << keysPerTable << " keys" << endl;
+        OUTSTREAM << "---------------------------------------------" << endl;
+
+        vector<string> keys;
+        for (size_t i = 0; i < keysPerTable; i++) keys.push_back("field" + to_string(i));
+
+        size_t tableBytes = 0;
+        {
+            vector<HashTable> tables;
+            tables.reserve(count);
+            const double tableMs = timeMs([&] {
+                for (size_t t = 0; t < count; t++) {
+                    HashTable& table = tables.emplace_back();
+                    for (size_t i = 0; i < keysPerTable; i++) table.insert(keys[i], static_cast<int>(t + i));
+                }
+            });
+            report("HashTable construct + fill", tableMs, count);
+            tableBytes = sizeof(HashTable) + tables.front().memoryUsage().total();
+        }
+        size_t orderedBytes = 0;
+        {
+            vector<OrderedHashTable> tables;
+            tables.reserve(count);
+            const double orderedMs = timeMs([&] {
+                for (size_t t = 0; t < count; t++) {
+                    OrderedHashTable& table = tables.emplace_back();
+                    for (size_t i = 0; i < keysPerTable; i++) table.insert(keys[i], static_cast<int>(t + i));
+                }
+            });
+            report("OrderedHashTable construct + fill", orderedMs, count);
+            orderedBytes = tables.front().bytes();
+            sink(tables.back().isInline());
+        }
+        OUTSTREAM << "  bytes per table: HashTable " << tableBytes << ", OrderedHashTable " << orderedBytes << endl;
+        OUTSTREAM << endl;
+    }
+#endif
+
+    return 0;
+}
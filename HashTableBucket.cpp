@@ -9,6 +9,8 @@
  */
 
 #include "HashTableBucket.h"
+#include "KeyCompare.h"
+#include <functional>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -22,6 +24,17 @@ HashTableBucket::HashTableBucket() {
     makeESS();
 }
 
+/* Purpose: Allocator-extended default constructor for HashTableBucket.
+ * Parameters:
+ *    alloc – allocator used for the bucket's key storage
+ * Behavior:
+ *    Same as the default constructor, but the key is allocated from the given
+ *    memory resource. Called by pmr containers through uses-allocator construction.
+ */
+HashTableBucket::HashTableBucket(const allocator_type& alloc) : key("SENTINEL_KEY_42", alloc) {
+    makeESS();
+}
+
 /* Purpose: Parameterized constructor for HashTableBucket.
  * Parameters:
  *    key – string key to store in the bucket
@@ -33,16 +46,60 @@ HashTableBucket::HashTableBucket(std::string key, const int value) {
     load(std::move(key), value);
 }
 
+/* Purpose: Allocator-extended copy constructor for HashTableBucket.
+ * Parameters:
+ *    other – bucket to copy
+ *    alloc – allocator used for the copied key
+ */
+HashTableBucket::HashTableBucket(const HashTableBucket& other, const allocator_type& alloc)
+    : key(other.key, alloc), value(other.value), type(other.type), referenced(other.referenced),
+      hash(other.hash), expiry(other.expiry) {
+}
+
+/* Purpose: Allocator-extended move constructor for HashTableBucket.
+ * Parameters:
+ *    other – bucket to move from
+ *    alloc – allocator used for the new key
+ * Behavior:
+ *    Steals the key storage when both allocators share a memory resource,
+ *    otherwise copies the key into the new resource.
+ */
+HashTableBucket::HashTableBucket(HashTableBucket&& other, const allocator_type& alloc)
+    : key(std::move(other.key), alloc), value(other.value), type(other.type), referenced(other.referenced),
+      hash(other.hash), expiry(other.expiry) {
+}
+
 /* Purpose: Loads a key-value pair into the bucket.
  * Parameters:
  *    key – string key to store
  *    value – integer value to associate
+ *    newHash – HashTable::hash() of the key (see matches())
  * Behavior:
- *    Updates the bucket's key and value, then marks it as NORMAL.
+ *    Updates the bucket's key and value, then marks it as NORMAL with the
+ *    access bit clear and no expiry.
  */
-void HashTableBucket::load(std::string newKey, const int newValue) {
+void HashTableBucket::load(const std::string_view newKey, const int newValue, const uint64_t newHash) {
+    key.assign(newKey);
+    value = newValue;
+    hash = newHash;
+    referenced = false;
+    expiry = std::chrono::steady_clock::time_point::max();
+    makeNormal();
+}
+
+/* Purpose: Loads a key-value pair, taking over the key's storage.
+ * Parameters:
+ *    newKey – key to store; its bytes are adopted if it uses the bucket's
+ *             memory resource, else copied
+ *    newValue – integer value to associate
+ *    newHash – HashTable::hash() of the key
+ */
+void HashTableBucket::load(std::pmr::string&& newKey, const int newValue, const uint64_t newHash) {
     key = std::move(newKey);
     value = newValue;
+    hash = newHash;
+    referenced = false;
+    expiry = std::chrono::steady_clock::time_point::max();
     makeNormal();
 }
 
@@ -69,9 +126,70 @@ void HashTableBucket::makeEAR() {
  *    string – the bucket's key
  */
 std::string HashTableBucket::getKey() const {
+    return std::string(key);
+}
+
+/* Purpose: Views the key stored in the bucket without copying it.
+ * Returns:
+ *    string_view – valid until the bucket is loaded again or destroyed
+ */
+std::string_view HashTableBucket::getKeyView() const {
     return key;
 }
 
+/* Purpose: Retrieves the hash stored with the key.
+ * Returns:
+ *    uint64_t – the hash given to load(), which lets a table relocate the
+ *    entry without hashing the key again
+ */
+uint64_t HashTableBucket::getHash() const {
+    return hash;
+}
+
+/* Purpose: Checks whether the bucket holds a given key.
+ * Parameters:
+ *    otherKey – key to look for
+ *    otherHash – HashTable::hash() of otherKey
+ * Returns:
+ *    true if the bucket is NORMAL and holds otherKey
+ * Behavior:
+ *    Rejects on the full stored hash, then on the stored length, before
+ *    comparing any key bytes, so a mismatch almost never reads the key; the
+ *    bytes are compared by keysEqual()'s vector kernel.
+ */
+bool HashTableBucket::matches(const std::string_view otherKey, const uint64_t otherHash) const {
+    return type == BucketType::NORMAL && hash == otherHash && keysEqual(key, otherKey);
+}
+
+/* Purpose: Retrieves the allocator used for the bucket's key.
+ * Returns:
+ *    allocator_type – polymorphic allocator bound to the key's memory resource
+ */
+HashTableBucket::allocator_type HashTableBucket::getAllocator() const {
+    return key.get_allocator();
+}
+
+/* Purpose: Returns the bytes the key holds from its memory resource.
+ * Returns:
+ *    size_t – 0 if the key fits the string's inline buffer, else
+ *    capacity() + 1, the size of its heap block
+ */
+size_t HashTableBucket::keyHeapBytes() const {
+    const char* inlineBuffer = reinterpret_cast<const char*>(&key);
+    const std::less<const char*> before;
+    if (!before(key.data(), inlineBuffer) && before(key.data(), inlineBuffer + sizeof(key))) return 0;
+    return key.capacity() + 1;
+}
+
+/* Purpose: Releases key storage the key no longer needs.
+ * Behavior:
+ *    Keys grown by reuse or copy-assignment may keep a block larger than
+ *    their length; short keys move back into the inline buffer.
+ */
+void HashTableBucket::shrinkKey() {
+    key.shrink_to_fit();
+}
+
 /* Purpose: Retrieves the value stored in the bucket.
  * Returns:
  *    int – the bucket's value
@@ -98,6 +216,60 @@ void HashTableBucket::setValue(const int newValue) {
     value = newValue;
 }
 
+/* Purpose: Sets the CLOCK access bit.
+ */
+void HashTableBucket::markReferenced() {
+    referenced = true;
+}
+
+/* Purpose: Clears the CLOCK access bit, giving the bucket a second chance.
+ */
+void HashTableBucket::clearReferenced() {
+    referenced = false;
+}
+
+/* Purpose: Checks the CLOCK access bit.
+ * Returns:
+ *    true if the bucket was looked up since the clock hand last passed it
+ */
+bool HashTableBucket::isReferenced() const {
+    return referenced;
+}
+
+/* Purpose: Sets the time after which the bucket's entry is stale.
+ * Parameters:
+ *    newExpiry – expiry time; time_point::max() means never
+ */
+void HashTableBucket::setExpiry(const std::chrono::steady_clock::time_point newExpiry) {
+    expiry = newExpiry;
+}
+
+/* Purpose: Checks whether the bucket's entry has outlived its TTL.
+ * Parameters:
+ *    now – current time
+ * Returns:
+ *    true if the entry has an expiry at or before now
+ */
+bool HashTableBucket::isExpired(const std::chrono::steady_clock::time_point now) const {
+    return expiry <= now;
+}
+
+/* Purpose: Checks whether the bucket's entry has a TTL at all.
+ * Returns:
+ *    true if an expiry is set
+ */
+bool HashTableBucket::hasExpiry() const {
+    return expiry != std::chrono::steady_clock::time_point::max();
+}
+
+/* Purpose: Retrieves the time the bucket's entry expires.
+ * Returns:
+ *    time_point – expiry, or time_point::max() if the entry has no TTL
+ */
+std::chrono::steady_clock::time_point HashTableBucket::getExpiry() const {
+    return expiry;
+}
+
 /* Purpose: Checks if the bucket is considered empty.
  * Returns:
  *    true if the bucket type is ESS or EAR, false otherwise
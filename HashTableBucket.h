@@ -2,31 +2,63 @@
  * HashTableBucket.h
  */
 #pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 
-enum class BucketType {NORMAL, ESS, EAR};
+enum class BucketType : uint8_t {NORMAL, ESS, EAR};
 
 class HashTableBucket {
     private:
-        std::string key = "SENTINEL_KEY_42"; // sentinel for ESS buckets
+        std::pmr::string key{"SENTINEL_KEY_42"}; // sentinel for ESS buckets
         int value = 0;
         BucketType type = BucketType::ESS;
+        bool referenced = false; // CLOCK access bit, set by HashTable::lookup()
+        uint64_t hash = 0; // HashTable::hash() of the key, so neither rehashing nor a mismatch reads the key
+        std::chrono::steady_clock::time_point expiry = std::chrono::steady_clock::time_point::max(); // max = no TTL
 
     public:
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+
         HashTableBucket();  // ESS by default
+        explicit HashTableBucket(const allocator_type& alloc);
         HashTableBucket(std::string key, int value);
+        HashTableBucket(const HashTableBucket& other) = default;
+        HashTableBucket(const HashTableBucket& other, const allocator_type& alloc);
+        HashTableBucket(HashTableBucket&& other) noexcept = default;
+        HashTableBucket(HashTableBucket&& other, const allocator_type& alloc);
+        HashTableBucket& operator=(const HashTableBucket& other) = default;
+        HashTableBucket& operator=(HashTableBucket&& other) = default;
 
-        void load(std::string newKey, int newValue);
+        void load(std::string_view newKey, int newValue, uint64_t newHash = 0);
+        void load(std::pmr::string&& newKey, int newValue, uint64_t newHash);
 
         void makeESS();
         void makeNormal();
         void makeEAR();
 
         [[nodiscard]] std::string getKey() const;
+        [[nodiscard]] std::string_view getKeyView() const;
+        [[nodiscard]] uint64_t getHash() const;
+        [[nodiscard]] bool matches(std::string_view otherKey, uint64_t otherHash) const;
+        [[nodiscard]] allocator_type getAllocator() const;
+        [[nodiscard]] size_t keyHeapBytes() const;
+        void shrinkKey();
         [[nodiscard]] int getValue() const;
         int& getValueRef();
         void setValue(int newValue);
 
+        void markReferenced();
+        void clearReferenced();
+        [[nodiscard]] bool isReferenced() const;
+
+        void setExpiry(std::chrono::steady_clock::time_point newExpiry);
+        [[nodiscard]] bool isExpired(std::chrono::steady_clock::time_point now) const;
+        [[nodiscard]] bool hasExpiry() const;
+        [[nodiscard]] std::chrono::steady_clock::time_point getExpiry() const;
+
         [[nodiscard]] bool isEmpty() const;
         [[nodiscard]] bool isEmptySinceStart() const;
         [[nodiscard]] bool isEmptyAfterRemove() const;
@@ -4,8 +4,15 @@
  * Write your tests in this file
  */
 #include <iostream>
+#include "ConstexprHashTable.h"
 #include "HashTable.h"
 
+// the same animals, built during compilation instead of by repeated insert()
+constexpr ConstexprHashTable animalTable({{"Wolf", 27}, {"Bear", 59}, {"Chicken", 5}, {"Worm", 1}, {"Cat", 12},
+                                          {"Dog", 14}, {"Lizard", 3}, {"Ostrich", 32}, {"Komodo Dragon", 40},
+                                          {"Snake", 20}});
+static_assert(animalTable.get("Komodo Dragon") == 40);
+
 
 int main() {
     HashTable hashTable;
@@ -38,5 +45,10 @@ int main() {
 
     std::cout << hashTable << std::endl;
 
+    std::cout << "Compile-time table (seed " << animalTable.seed() << ", " << animalTable.capacity() << " slots)"
+            << std::endl;
+    std::cout << "Wolf -> " << animalTable.get("Wolf").value() << ", Horse present: " << animalTable.contains("Horse")
+            << std::endl;
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,1453 @@
+/**
+ * HashTableExtendedTests.cpp
+ *
+ * Tests for the HashTable features that go beyond the Project 4 interface
+ * (allocators, bulk operations, alternative tables, ...). HashTableTests.cpp
+ * is the unmodified grading harness; this file follows the same layout: each
+ * test is a block guarded by its own #define that prints CORRECT or ERROR.
+ */
+#define RUN_TESTS
+
+#ifdef RUN_TESTS
+
+#include "ConcurrentCounterTable.h"
+#include "ConcurrentHashTable.h"
+#include "ConstexprHashTable.h"
+#include "CuckooHashTable.h"
+#include "FrozenHashTable.h"
+#include "HashTable.h"
+#include "HugePageResource.h"
+#include "IntHashTable.h"
+#include "KeyCompare.h"
+#include "KeyHash.h"
+#include "OrderedHashTable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+#define OUTSTREAM cout
+
+#define HT_PMR_COUNTING_RESOURCE
+#define HT_PMR_MONOTONIC_ARENA
+#define HT_HUGE_PAGE_RESOURCE
+#define HT_UPSERT
+#define HT_BRACKET_OP_INSERT
+#define HT_CONCURRENT_COUNTER
+#define HT_CUCKOO
+#define HT_FREEZE
+#define HT_CONSTEXPR
+#define HT_BLOOM_FILTER
+#define HT_SNAPSHOT
+#define HT_BOUNDED_CACHE
+#define HT_KEY_COMPARE
+#define HT_CPU_DISPATCH
+#define HT_PARALLEL_SCAN
+#define HT_ASYNC_GET
+#define HT_MEMORY_USAGE
+#define HT_BULK_ERASE
+#define HT_SET_OPERATIONS
+#define HT_MOVE_SEMANTICS
+#define HT_INT_KEYS
+#define HT_CONCURRENT_ACCESSORS
+#define HT_DELTA_REPLICATION
+#define HT_PROBE_PATH
+#define HT_ORDERED
+#define HT_ORDERED_SMALL
+
+/* Purpose: memory_resource that forwards to an upstream resource and counts
+ *          every allocation and deallocation made through it.
+ */
+class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t allocations = 0;
+        size_t deallocations = 0;
+        size_t bytesAllocated = 0;
+        size_t bytesDeallocated = 0;
+
+        explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : upstream(upstream) {
+        }
+
+        [[nodiscard]] size_t bytesInUse() const {
+            return bytesAllocated - bytesDeallocated;
+        }
+
+    private:
+        std::pmr::memory_resource* upstream;
+
+        void* do_allocate(const size_t bytes, const size_t alignment) override {
+            allocations++;
+            bytesAllocated += bytes;
+            return upstream->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, const size_t bytes, const size_t alignment) override {
+            deallocations++;
+            bytesDeallocated += bytes;
+            upstream->deallocate(p, bytes, alignment);
+        }
+
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+};
+
+int main() {
+    constexpr size_t MAXHASH = HashTable::DEFAULT_INITIAL_CAPACITY;
+
+    OUTSTREAM << "+===========================+" << endl;
+    OUTSTREAM << "| HASH TABLE EXTENDED TESTS |" << endl;
+    OUTSTREAM << "+===========================+" << endl << endl;
+
+    // TEST: ALLOCATIONS GO THROUGH THE TABLE'S MEMORY RESOURCE
+    OUTSTREAM << "Testing HashTable with a counting memory resource" << endl;
+    OUTSTREAM << "-------------------------------------------------" << endl;
+#ifdef HT_PMR_COUNTING_RESOURCE
+    try {
+        CountingResource counter;
+        {
+            HashTable ht1(MAXHASH, &counter);
+            const size_t afterConstruction = counter.allocations;
+            if (afterConstruction == 0 || ht1.resource() != &counter)
+                OUTSTREAM << "ERROR: bucket array not allocated from resource *** " << __LINE__ << endl;
+
+            // keys longer than the small-string buffer must be allocated from the resource too
+            for (int i = 10; i < static_cast<int>(10 + 4 * MAXHASH); i++) {
+                ht1.insert("a key long enough to need the heap " + to_string(i), i);
+            }
+            if (counter.allocations <= afterConstruction + 4 * MAXHASH)
+                OUTSTREAM << "ERROR: keys not allocated from resource *** " << __LINE__ << endl;
+
+            if (ht1.get("a key long enough to need the heap 17") == 17)
+                OUTSTREAM << "CORRECT: table works after resizing inside the resource" << endl;
+            else
+                OUTSTREAM << "ERROR: lookup failed *** " << __LINE__ << endl;
+
+            HashTable copy(ht1, std::pmr::new_delete_resource());
+            if (copy.resource() == std::pmr::new_delete_resource() && copy.size() == ht1.size())
+                OUTSTREAM << "CORRECT: allocator-extended copy uses the new resource" << endl;
+            else
+                OUTSTREAM << "ERROR: allocator-extended copy *** " << __LINE__ << endl;
+        }
+        if (counter.bytesInUse() == 0 && counter.allocations == counter.deallocations)
+            OUTSTREAM << "CORRECT: every byte returned to the resource (" << counter.allocations
+                    << " allocations)" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: " << counter.bytesInUse() << " bytes leaked *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST PMR COUNTING RESOURCE ***" << endl << endl;
+#endif
+
+    // TEST: TABLE INSIDE A MONOTONIC ARENA
+    OUTSTREAM << "Testing HashTable inside a monotonic arena" << endl;
+    OUTSTREAM << "------------------------------------------" << endl;
+#ifdef HT_PMR_MONOTONIC_ARENA
+    try {
+        CountingResource upstream;
+        {
+            std::pmr::monotonic_buffer_resource arena(64 * 1024, &upstream);
+            std::pmr::vector<HashTable> tables(&arena);
+            for (int t = 0; t < 4; t++) {
+                tables.emplace_back(); // uses-allocator construction picks up the arena
+                for (int i = 1; i <= static_cast<int>(MAXHASH); i++) {
+                    tables.back().insert(to_string(t) + ":" + to_string(i), i);
+                }
+            }
+
+            bool anyErrors = false;
+            for (int t = 0; t < 4; t++) {
+                anyErrors |= tables[t].resource() != &arena;
+                anyErrors |= tables[t].get(to_string(t) + ":3") != 3;
+            }
+            if (!anyErrors)
+                OUTSTREAM << "CORRECT: pmr container propagated the arena to its tables" << endl;
+            else
+                OUTSTREAM << "ERROR: tables not placed in the arena *** " << __LINE__ << endl;
+        }
+        if (upstream.bytesInUse() == 0)
+            OUTSTREAM << "CORRECT: arena released in one step (" << upstream.allocations
+                    << " upstream allocations)" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: arena did not release its memory *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST PMR MONOTONIC ARENA ***" << endl << endl;
+#endif
+
+    // TEST: BUCKET ARRAY ON HUGE PAGES
+    OUTSTREAM << "Testing HashTable backed by HugePageResource" << endl;
+    OUTSTREAM << "--------------------------------------------" << endl;
+#ifdef HT_HUGE_PAGE_RESOURCE
+    try {
+        const HugePageMode modes[] = {HugePageMode::NONE, HugePageMode::TRANSPARENT, HugePageMode::EXPLICIT};
+        const char* names[] = {"NONE", "TRANSPARENT", "EXPLICIT"};
+
+        for (int m = 0; m < 3; m++) {
+            CountingResource upstream;
+            {
+                // a low threshold forces the bucket array through mmap even for a small table
+                HugePageResource pages(modes[m], NumaPolicy::INTERLEAVE, 0, 4096, &upstream);
+                HashTable ht1(1024, &pages);
+                for (int i = 100; i < 400; i++) {
+                    ht1.insert(to_string(i), i);
+                }
+                if (ht1.size() == 300 && ht1.get("250") == 250)
+                    OUTSTREAM << "CORRECT: " << names[m] << " table works (explicit huge pages: "
+                            << pages.explicitMappings() << ", fallbacks: " << pages.fallbackMappings() << ")" << endl;
+                else
+                    OUTSTREAM << "ERROR: " << names[m] << " table lost entries *** " << __LINE__ << endl;
+
+                // mapped blocks start on a 2MB boundary, so any alignment up to that holds
+                void* block = pages.allocate(3 * 4096, 1024 * 1024);
+                if (reinterpret_cast<uintptr_t>(block) % HugePageResource::HUGE_PAGE_SIZE != 0)
+                    OUTSTREAM << "ERROR: " << names[m] << " block not 2MB-aligned *** " << __LINE__ << endl;
+                pages.deallocate(block, 3 * 4096, 1024 * 1024);
+            }
+            if (upstream.bytesInUse() != 0)
+                OUTSTREAM << "ERROR: " << names[m] << " leaked small blocks *** " << __LINE__ << endl;
+        }
+        OUTSTREAM << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST HUGE PAGE RESOURCE ***" << endl << endl;
+#endif
+
+    // TEST: SINGLE-PROBE UPSERTS
+    OUTSTREAM << "Testing insertOrAssign(), tryEmplace(), findOrInsert(), update(), merge()" << endl;
+    OUTSTREAM << "--------------------------------------------------------------------------" << endl;
+#ifdef HT_UPSERT
+    try {
+        HashTable ht1;
+        bool anyErrors = false;
+
+        anyErrors |= !ht1.insertOrAssign("apple", 1);
+        anyErrors |= ht1.insertOrAssign("apple", 2);
+        anyErrors |= ht1.get("apple") != 2;
+
+        auto [value, inserted] = ht1.tryEmplace("apple", 99);
+        anyErrors |= inserted || value != 2;
+        auto [pearValue, pearInserted] = ht1.tryEmplace("pear", 7);
+        anyErrors |= !pearInserted || pearValue != 7;
+
+        ht1.findOrInsert("plum") += 5;
+        anyErrors |= ht1.get("plum") != 5;
+
+        anyErrors |= ht1.update("plum", [](int v) { return v * 3; }) != 15;
+        anyErrors |= ht1.update("fig", [](int v) { return v + 4; }) != 4;
+
+        for (int i = 0; i < 10; i++) ht1.merge("count", 2);
+        anyErrors |= ht1.get("count") != 20;
+        anyErrors |= ht1.size() != 5;
+
+        // upserts must keep working across resizes and after removes leave EAR buckets
+        for (size_t i = 0; i < 20 * MAXHASH; i++) ht1.merge(to_string(i % (4 * MAXHASH)), 1);
+        for (size_t i = 0; i < 4 * MAXHASH; i += 2) ht1.remove(to_string(i));
+        for (size_t i = 0; i < 4 * MAXHASH; i++) ht1.merge(to_string(i), 1);
+        for (size_t i = 0; i < 4 * MAXHASH; i++) anyErrors |= ht1.get(to_string(i)) != (i % 2 == 0 ? 1 : 6);
+        anyErrors |= ht1.size() != 5 + 4 * MAXHASH;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: upserts behaved as expected" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: an upsert returned the wrong result *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST UPSERT ***" << endl << endl;
+#endif
+
+    // TEST: BRACKET OPERATOR INSERTS MISSING KEYS
+    OUTSTREAM << "Testing operator[] with a missing key" << endl;
+    OUTSTREAM << "-------------------------------------" << endl;
+#ifdef HT_BRACKET_OP_INSERT
+    try {
+        HashTable ht1;
+        const int initial = ht1["missing"];
+        ht1["missing"]++;
+        if (initial == 0 && ht1.get("missing") == 1 && ht1.size() == 1)
+            OUTSTREAM << "CORRECT: operator[] inserted a zero value" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: operator[] did not insert *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST OPERATOR[] INSERT ***" << endl << endl;
+#endif
+
+    // TEST: CONCURRENT COUNTER TABLE
+    OUTSTREAM << "Testing ConcurrentCounterTable with 4 threads" << endl;
+    OUTSTREAM << "---------------------------------------------" << endl;
+#ifdef HT_CONCURRENT_COUNTER
+    try {
+        constexpr int threads = 4;
+        constexpr int perThread = 20000;
+        constexpr int distinct = 100;
+        ConcurrentCounterTable counts(distinct);
+
+        vector<thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&counts, t] {
+                ConcurrentCounterTable::LocalBuffer buffer(counts, 16);
+                for (int i = 0; i < perThread; i++) {
+                    // half direct atomic increments, half through the combining buffer
+                    if (i % 2 == 0) counts.increment("key" + to_string((i + t) % distinct));
+                    else buffer.add("key" + to_string((i + t) % distinct));
+                }
+            });
+        }
+        for (thread& worker : workers) worker.join();
+
+        int64_t total = 0;
+        bool anyErrors = counts.size() != distinct;
+        for (int k = 0; k < distinct; k++) {
+            const auto count = counts.get("key" + to_string(k));
+            anyErrors |= !count || *count != threads * perThread / distinct;
+            total += count.value_or(0);
+        }
+        if (!anyErrors && total == threads * perThread)
+            OUTSTREAM << "CORRECT: every increment counted exactly once" << endl;
+        else
+            OUTSTREAM << "ERROR: lost or duplicated increments (total " << total << ") *** " << __LINE__ << endl;
+
+        try {
+            ConcurrentCounterTable tiny(4);
+            for (int i = 0; i < 100; i++) tiny.increment(to_string(i));
+            OUTSTREAM << "ERROR: full table accepted new keys *** " << __LINE__ << endl << endl;
+        } catch (length_error&) {
+            OUTSTREAM << "CORRECT: full table threw length_error" << endl;
+        }
+
+        // a flush that fails partway keeps only the deltas it did not add, so a retry adds nothing twice
+        ConcurrentCounterTable partial(4);
+        {
+            ConcurrentCounterTable::LocalBuffer buffer(partial, 1000);
+            for (int i = 0; i < 100; i++) buffer.add(to_string(i), i + 1);
+            int64_t counted[2] = {};
+            for (int64_t& total : counted) {
+                try {
+                    buffer.flush();
+                } catch (length_error&) {
+                }
+                for (const string& key : partial.keys()) total += *partial.get(key);
+            }
+            if (partial.size() == 6 && counted[0] > 0 && counted[1] == counted[0])
+                OUTSTREAM << "CORRECT: retried flush did not add its deltas twice" << endl;
+            else
+                OUTSTREAM << "ERROR: retried flush counted " << counted[1] << " vs " << counted[0] << " *** "
+                        << __LINE__ << endl;
+        }
+
+        // a buffer that cannot flush into a full table must not throw from its destructor
+        ConcurrentCounterTable tiny(4);
+        {
+            ConcurrentCounterTable::LocalBuffer buffer(tiny, 1000);
+            for (int i = 0; i < 100; i++) buffer.add(to_string(i));
+        }
+        if (tiny.size() == 6)
+            OUTSTREAM << "CORRECT: LocalBuffer dropped deltas for a full table without terminating" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: LocalBuffer filled " << tiny.size() << " slots *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST CONCURRENT COUNTER ***" << endl << endl;
+#endif
+
+    // TEST: CUCKOO HASH TABLE
+    OUTSTREAM << "Testing CuckooHashTable at high load" << endl;
+    OUTSTREAM << "------------------------------------" << endl;
+#ifdef HT_CUCKOO
+    try {
+        CuckooHashTable ht1(4096);
+        int inserted = 0;
+        while (ht1.alpha() < 0.9 && ht1.capacity() == 4096) {
+            if (!ht1.insert("c" + to_string(inserted), inserted)) break;
+            inserted++;
+        }
+        if (ht1.capacity() == 4096 && ht1.alpha() >= 0.9)
+            OUTSTREAM << "CORRECT: reached load factor " << ht1.alpha() << " without resizing" << endl;
+        else
+            OUTSTREAM << "ERROR: resized at load factor " << ht1.alpha() << " *** " << __LINE__ << endl;
+
+        bool anyErrors = ht1.insert("c1", 1) || ht1.size() != static_cast<size_t>(inserted);
+        for (int i = 0; i < inserted; i++) anyErrors |= ht1.get("c" + to_string(i)) != i;
+        for (int i = 0; i < inserted; i += 3) anyErrors |= !ht1.remove("c" + to_string(i));
+        for (int i = 0; i < inserted; i++) anyErrors |= ht1.contains("c" + to_string(i)) != (i % 3 != 0);
+        anyErrors |= ht1.contains("missing") || ht1.remove("missing");
+        ht1["c1"] += 10;
+        ht1["new"]++;
+        anyErrors |= ht1.get("c1") != 11 || ht1.get("new") != 1;
+        anyErrors |= ht1.keys().size() != ht1.size();
+
+        // keep inserting until it must grow; every key must survive the resize
+        for (int i = inserted; i < 3 * inserted; i++) ht1.insert("c" + to_string(i), i);
+        for (int i = inserted; i < 3 * inserted; i++) anyErrors |= ht1.get("c" + to_string(i)) != i;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: lookups, removes and resizes agree (stash holds " << ht1.stashSize() << ")"
+                    << endl << endl;
+        else
+            OUTSTREAM << "ERROR: cuckoo table lost or corrupted entries *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST CUCKOO ***" << endl << endl;
+#endif
+
+    // TEST: FROZEN HASH TABLE
+    OUTSTREAM << "Testing HashTable::freeze() and FrozenHashTable files" << endl;
+    OUTSTREAM << "-----------------------------------------------------" << endl;
+#ifdef HT_FREEZE
+    try {
+        HashTable ht1;
+        for (int i = 0; i < 5000; i++) ht1.insert("frozen-" + to_string(i * 37), i);
+        for (int i = 0; i < 5000; i += 5) ht1.remove("frozen-" + to_string(i * 37));
+
+        const FrozenHashTable frozen = ht1.freeze(4);
+        // checks every key of ht1 plus some that were never or no longer inserted
+        auto matches = [&ht1](const FrozenHashTable& table) {
+            bool ok = table.size() == ht1.size();
+            for (int i = 0; i < 5000; i++) {
+                const string key = "frozen-" + to_string(i * 37);
+                ok &= table.get(key) == ht1.get(key);
+                ok &= !table.contains("other-" + to_string(i));
+            }
+            return ok;
+        };
+
+        if (matches(frozen))
+            OUTSTREAM << "CORRECT: frozen table matches the mutable table" << endl;
+        else
+            OUTSTREAM << "ERROR: frozen table disagrees with the mutable table *** " << __LINE__ << endl;
+
+        const string path = (filesystem::temp_directory_path() / "HashTableExtendedTests.frozen").string();
+        frozen.save(path);
+        const FrozenHashTable loaded = FrozenHashTable::load(path);
+        const FrozenHashTable mapped = FrozenHashTable::map(path);
+        if (matches(loaded) && matches(mapped))
+            OUTSTREAM << "CORRECT: loaded and mapped images match (mapped: " << mapped.isMapped() << ")" << endl;
+        else
+            OUTSTREAM << "ERROR: saved image did not round-trip *** " << __LINE__ << endl;
+
+        // a foreign file, a header whose sizes would overflow, and sections of garbage after a valid header
+        const string image((istreambuf_iterator<char>(ifstream(path, ios::binary).rdbuf())), {});
+        string hugeSize = image;
+        const uint64_t tooMany = uint64_t{1} << 61;
+        memcpy(hugeSize.data() + 8, &tooMany, sizeof(tooMany));
+        uint64_t keyBytes;
+        memcpy(&keyBytes, image.data() + 40, sizeof(keyBytes));
+        string garbage = image;
+        fill(garbage.begin() + 48, garbage.end() - static_cast<ptrdiff_t>(keyBytes), '\xff');
+        int rejected = 0;
+        for (const string& corrupt : {string("not a table"), hugeSize, garbage}) {
+            ofstream(path, ios::binary | ios::trunc) << corrupt;
+            try {
+                FrozenHashTable bad = FrozenHashTable::map(path);
+            } catch (runtime_error&) {
+                rejected++;
+            }
+        }
+        if (rejected == 3)
+            OUTSTREAM << "CORRECT: corrupt images rejected" << endl;
+        else
+            OUTSTREAM << "ERROR: corrupt image accepted *** " << __LINE__ << endl;
+        filesystem::remove(path);
+
+        // at a load of 1.0 the last buckets of a big build ran out of pilots and were reported as duplicates
+        vector<pair<string, int>> many;
+        for (int i = 0; i < (1 << 22); i++) many.emplace_back("many-" + to_string(i), i);
+        const FrozenHashTable large(many);
+        bool largeOk = large.size() == many.size() && !large.contains("many-");
+        for (size_t i = 0; i < many.size(); i += 7) largeOk &= large.get(many[i].first) == many[i].second;
+        many.emplace_back("many-12345", 0);
+        try {
+            FrozenHashTable duplicate(many);
+            largeOk = false;
+        } catch (invalid_argument&) {
+        }
+        if (largeOk)
+            OUTSTREAM << "CORRECT: froze " << large.size() << " keys and rejected a real duplicate" << endl;
+        else
+            OUTSTREAM << "ERROR: large frozen build failed *** " << __LINE__ << endl;
+
+        const FrozenHashTable empty = HashTable().freeze();
+        if (empty.size() == 0 && !empty.contains(""))
+            OUTSTREAM << "CORRECT: empty table freezes" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: empty frozen table *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST FREEZE ***" << endl << endl;
+#endif
+
+    // TEST: COMPILE-TIME HASH TABLE
+    OUTSTREAM << "Testing ConstexprHashTable" << endl;
+    OUTSTREAM << "--------------------------" << endl;
+#ifdef HT_CONSTEXPR
+    {
+        static constexpr ConstexprHashTable colors({{"red", 0xff0000}, {"green", 0x00ff00}, {"blue", 0x0000ff},
+                                                    {"white", 0xffffff}, {"black", 0}});
+        static_assert(colors.get("green") == 0x00ff00);
+        static_assert(colors.contains("black") && !colors.contains("purple"));
+        static_assert(colors.size() == 5);
+
+        // the same lookups again at run time, on keys the compiler cannot see
+        const vector<string> names = {"red", "green", "blue", "white", "black"};
+        bool anyErrors = colors.get(string("purple")).has_value();
+        for (const string& name : names) anyErrors |= !colors.contains(name);
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: compile-time table (seed " << colors.seed() << ") answers at run time" << endl
+                    << endl;
+        else
+            OUTSTREAM << "ERROR: run-time lookups disagree *** " << __LINE__ << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST CONSTEXPR ***" << endl << endl;
+#endif
+
+    // TEST: BLOOM FILTER FRONT-END
+    OUTSTREAM << "Testing HashTable with a Bloom filter front-end" << endl;
+    OUTSTREAM << "-----------------------------------------------" << endl;
+#ifdef HT_BLOOM_FILTER
+    try {
+        HashTable ht1;
+        for (int i = 0; i < 100; i++) ht1.insert("early" + to_string(i), i);
+        ht1.enableFilter(); // existing keys are loaded into the filter
+
+        bool anyErrors = false;
+        for (int i = 0; i < 2000; i++) ht1.insert("late" + to_string(i), i); // several resizes
+        for (int i = 0; i < 2000; i += 2) anyErrors |= !ht1.remove("late" + to_string(i));
+        for (int i = 0; i < 2000; i += 2) ht1.insert("late" + to_string(i), -i); // reuse EAR buckets
+
+        for (int i = 0; i < 100; i++) anyErrors |= ht1.get("early" + to_string(i)) != i;
+        for (int i = 0; i < 2000; i++) anyErrors |= ht1.get("late" + to_string(i)) != (i % 2 == 0 ? -i : i);
+        anyErrors |= ht1.insert("late3", 0) || ht1.size() != 2100;
+
+        // removes past the rebuild threshold must leave the table and filter consistent
+        for (int i = 0; i < 2000; i++) anyErrors |= !ht1.remove("late" + to_string(i));
+        for (int i = 0; i < 100; i++) anyErrors |= !ht1.contains("early" + to_string(i));
+
+        size_t falsePositives = 0;
+        for (int i = 0; i < 10000; i++) falsePositives += ht1.getFilter()->mayContain(hash<string>{}("x" + to_string(i)));
+        anyErrors |= ht1.getFilter() == nullptr || falsePositives > 1000;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: filter stayed in sync through inserts, removes and resizes" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: filtered table gave a wrong answer *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST BLOOM FILTER ***" << endl << endl;
+#endif
+
+    // TEST: COPY-ON-WRITE SNAPSHOTS
+    OUTSTREAM << "Testing HashTable::snapshot() while the table changes" << endl;
+    OUTSTREAM << "-----------------------------------------------------" << endl;
+#ifdef HT_SNAPSHOT
+    try {
+        HashTable ht1;
+        for (int i = 0; i < 1500; i++) ht1.insert("key" + to_string(i), i);
+        const HashTable before = ht1.snapshot();
+        bool anyErrors = ht1.sharedPages() == 0;
+
+        // updates, removes, new keys and a resize, all after the snapshot was taken
+        for (int i = 0; i < 1500; i += 3) ht1.merge("key" + to_string(i), 1000);
+        for (int i = 1; i < 1500; i += 3) anyErrors |= !ht1.remove("key" + to_string(i));
+        for (int i = 1500; i < 3000; i++) ht1["key" + to_string(i)] = i;
+
+        // the snapshot still answers with the old contents
+        anyErrors |= before.size() != 1500 || before.keys().size() != 1500;
+        for (int i = 0; i < 3000; i++) {
+            const string key = "key" + to_string(i);
+            if (i < 1500) anyErrors |= before.get(key) != i;
+            else anyErrors |= before.contains(key);
+        }
+
+        // while the table has the new ones
+        for (int i = 0; i < 3000; i++) {
+            const string key = "key" + to_string(i);
+            if (i < 1500 && i % 3 == 1) anyErrors |= ht1.contains(key);
+            else anyErrors |= ht1.get(key) != (i < 1500 && i % 3 == 0 ? i + 1000 : i);
+        }
+
+        // writing to a fresh snapshot copies only the touched page
+        const HashTable after = ht1.snapshot();
+        const size_t shared = ht1.sharedPages();
+        ht1.insertOrAssign("key0", -1);
+        anyErrors |= ht1.sharedPages() != shared - 1 || after.get("key0") != 1000 || ht1.get("key0") != -1;
+
+        // only snapshots share pages; a copy owns its own, so it outlives an arena the source lived in
+        CountingResource upstream;
+        optional<HashTable> copied;
+        HashTable assigned;
+        {
+            std::pmr::monotonic_buffer_resource arena(&upstream);
+            HashTable inArena(HashTable::DEFAULT_INITIAL_CAPACITY, &arena);
+            for (int i = 0; i < 1500; i++) inArena.insert("a key long enough to need the heap " + to_string(i), i);
+            copied.emplace(inArena);
+            assigned = inArena;
+            anyErrors |= inArena.sharedPages() != 0 || copied->resource() != std::pmr::get_default_resource() ||
+                         assigned.resource() != std::pmr::get_default_resource();
+        }
+        anyErrors |= upstream.bytesInUse() != 0 || copied->size() != 1500 || assigned.size() != 1500;
+        for (int i = 0; i < 1500; i++) {
+            const string key = "a key long enough to need the heap " + to_string(i);
+            anyErrors |= copied->get(key) != i || assigned.get(key) != i;
+        }
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: snapshot kept its contents through updates, removes and a resize" << endl
+                    << endl;
+        else
+            OUTSTREAM << "ERROR: snapshot saw a later write *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST SNAPSHOT ***" << endl << endl;
+#endif
+
+    // TEST: BOUNDED CACHE MODE
+    OUTSTREAM << "Testing HashTable bounded cache mode (CLOCK eviction and TTLs)" << endl;
+    OUTSTREAM << "--------------------------------------------------------------" << endl;
+#ifdef HT_BOUNDED_CACHE
+    try {
+        HashTable ht1;
+        ht1.enableEviction(64);
+        const size_t boundedCapacity = ht1.capacity();
+
+        // hot keys are looked up between inserts, so CLOCK keeps giving them a second chance
+        bool anyErrors = false;
+        for (int i = 0; i < 8; i++) ht1.insert("hot" + to_string(i), i);
+        for (int i = 0; i < 2000; i++) {
+            ht1.insertOrAssign("cold" + to_string(i), i);
+            for (int h = 0; h < 8; h++) anyErrors |= ht1.lookup("hot" + to_string(h)) != h;
+            anyErrors |= ht1.size() > 64;
+        }
+        anyErrors |= ht1.capacity() != boundedCapacity || ht1.keys().size() != 64;
+        anyErrors |= !ht1.contains("cold1999") || ht1.contains("cold0");
+
+        const HashTable::CacheStats stats = ht1.cacheStats();
+        anyErrors |= stats.hits != 16000 || stats.misses != 0 || stats.evictions != 2008 - 64;
+        anyErrors |= ht1.lookup("cold0").has_value() || ht1.cacheStats().misses != 1;
+
+        // an entry past its TTL reads as missing and is reclaimed by lookup()
+        ht1.insertWithTtl("stale", 1, chrono::milliseconds(-1));
+        ht1.insertWithTtl("fresh", 2, chrono::hours(1));
+        anyErrors |= ht1.contains("stale") || ht1.get("stale").has_value() || ht1.get("fresh") != 2;
+        const FrozenHashTable frozen = ht1.freeze(1); // a frozen copy must not bring an expired key back
+        anyErrors |= frozen.contains("stale") || frozen.get("fresh") != 2 || frozen.size() != ht1.keys().size();
+        anyErrors |= ht1.printMe().find("stale") != string::npos;
+        anyErrors |= ht1.lookup("stale").has_value() || ht1.cacheStats().expirations != 1;
+        anyErrors |= !ht1.insert("stale", 3) || ht1.get("stale") != 3; // plain insert has no TTL
+
+        ht1.disableEviction();
+        for (int i = 0; i < 200; i++) ht1.insert("more" + to_string(i), i);
+        anyErrors |= ht1.size() <= 64 || ht1.capacity() == boundedCapacity;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: table stayed at 64 entries, kept its hot keys and expired stale ones" << endl
+                    << endl;
+        else
+            OUTSTREAM << "ERROR: bounded table misbehaved *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST BOUNDED CACHE ***" << endl << endl;
+#endif
+
+    // TEST: VECTORIZED KEY COMPARISON
+    OUTSTREAM << "Testing every key compare kernel this CPU supports" << endl;
+    OUTSTREAM << "--------------------------------------------------" << endl;
+#ifdef HT_KEY_COMPARE
+    try {
+        bool anyErrors = false;
+        string kernelNames;
+        for (const CpuLevel level : ALL_CPU_LEVELS) {
+            if (!cpuLevelSupported(level)) continue;
+            const KeyCompareFn equal = keyCompareKernel(level);
+            kernelNames += string(" ") + cpuLevelName(level);
+
+            // a difference at every position, including each step's overlapping tail
+            for (size_t length = 0; length <= 260; length++) {
+                string a(length, 'k');
+                for (size_t i = 0; i < length; i++) a[i] = static_cast<char>('a' + i * 7 % 26);
+                anyErrors |= !equal(a.data(), string(a).data(), length);
+                for (size_t i = 0; i < length; i++) {
+                    string b = a;
+                    b[i] ^= 0x20;
+                    anyErrors |= equal(a.data(), b.data(), length);
+                }
+            }
+        }
+
+        // long keys that share a 200-byte prefix only differ in their last bytes
+        HashTable ht1;
+        const string prefix(200, 'p');
+        for (int i = 0; i < 500; i++) ht1.insert(prefix + to_string(i), i);
+        for (int i = 0; i < 500; i++) anyErrors |= ht1.get(prefix + to_string(i)) != i;
+        anyErrors |= ht1.contains(prefix + "500") || ht1.contains(prefix.substr(1) + "10") || ht1.size() != 500;
+        anyErrors |= !keysEqual(prefix, string(prefix)) || keysEqual(prefix, prefix + "x");
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: kernels" << kernelNames << " agree with memcmp (active: "
+                    << cpuLevelName(dispatchLevel()) << ")" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: a kernel gave the wrong answer *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST KEY COMPARE ***" << endl << endl;
+#endif
+
+    // TEST: CPU DISPATCH AND HASH KERNELS
+    OUTSTREAM << "Testing CPU dispatch and every supported hash kernel" << endl;
+    OUTSTREAM << "----------------------------------------------------" << endl;
+#ifdef HT_CPU_DISPATCH
+    try {
+        bool anyErrors = !cpuLevelSupported(CpuLevel::SCALAR) || !cpuLevelSupported(dispatchLevel());
+        for (const CpuLevel level : ALL_CPU_LEVELS) anyErrors |= parseCpuLevel(cpuLevelName(level)) != level;
+        anyErrors |= parseCpuLevel("avx1024").has_value();
+
+        string kernelNames;
+        for (const CpuLevel level : ALL_CPU_LEVELS) {
+            if (!cpuLevelSupported(level)) {
+                // asking for a kernel the CPU cannot run must fail loudly, not crash later
+                bool threw = false;
+                try {
+                    (void) keyHashKernel(level);
+                } catch (invalid_argument&) {
+                    threw = true;
+                }
+                anyErrors |= !threw;
+                continue;
+            }
+            const KeyHashFn hashFn = keyHashKernel(level);
+            kernelNames += string(" ") + cpuLevelName(level);
+
+            // deterministic, sensitive to every byte and to length, and well spread over 256 buckets
+            size_t buckets[256] = {};
+            for (int i = 0; i < 25600; i++) buckets[hashFn("key" + to_string(i)) & 255]++;
+            for (const size_t count : buckets) anyErrors |= count < 50 || count > 150;
+            for (size_t length = 1; length <= 70; length++) {
+                const string key(length, 'h');
+                anyErrors |= hashFn(key) != hashFn(string(key));
+                anyErrors |= hashFn(key) == hashFn(key + '\0') || hashFn(key) == hashFn(key.substr(1) + 'i');
+            }
+
+            // short keys must use all 64 bits; 32 bits of entropy would give about 128 full collisions here
+            vector<uint64_t> hashes;
+            for (uint64_t i = 0; i < (1 << 20); i++) {
+                const uint64_t bytes = i * 0x9e3779b97f4a7c15ULL; // spread over all 7 key bytes
+                hashes.push_back(hashFn(string_view(reinterpret_cast<const char*>(&bytes), 7)));
+            }
+            sort(hashes.begin(), hashes.end());
+            anyErrors |= adjacent_find(hashes.begin(), hashes.end()) != hashes.end();
+        }
+        anyErrors |= keyHash("dispatch") != keyHashKernel(dispatchLevel())("dispatch");
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: hash kernels" << kernelNames << " are consistent (dispatching to "
+                    << cpuLevelName(dispatchLevel()) << ")" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: dispatch or a hash kernel misbehaved *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST CPU DISPATCH ***" << endl << endl;
+#endif
+
+    // TEST: PARALLEL ITERATION AND MAP-REDUCE
+    OUTSTREAM << "Testing parallelForEach(), parallelReduce() and keys(threads)" << endl;
+    OUTSTREAM << "-------------------------------------------------------------" << endl;
+#ifdef HT_PARALLEL_SCAN
+    try {
+        HashTable ht1;
+        long long expectedSum = 0;
+        for (int i = 0; i < 20000; i++) {
+            ht1.insert("scan" + to_string(i), i);
+            expectedSum += i;
+        }
+        for (int i = 0; i < 20000; i += 4) {
+            ht1.remove("scan" + to_string(i)); // leave EAR buckets for the scans to skip
+            expectedSum -= i;
+        }
+
+        bool anyErrors = false;
+        for (const size_t threads : {1, 3, 8}) {
+            atomic<long long> sum{0};
+            atomic<size_t> visited{0};
+            ht1.parallelForEach([&](const string_view key, const int value) {
+                sum += value;
+                visited += key.substr(0, 4) == "scan";
+            }, threads);
+            anyErrors |= sum != expectedSum || visited != ht1.size();
+
+            const long long reduced = ht1.parallelReduce(0LL, [](string_view, const int value) {
+                return static_cast<long long>(value);
+            }, [](const long long a, const long long b) { return a + b; }, threads);
+            const size_t longest = ht1.parallelReduce(size_t{0}, [](const string_view key, int) {
+                return key.size();
+            }, [](const size_t a, const size_t b) { return max(a, b); }, threads);
+            anyErrors |= reduced != expectedSum || longest != string("scan19999").size();
+
+            anyErrors |= ht1.keys(threads) != ht1.keys(); // same slices, same bucket order
+        }
+
+        // a tiny table is one chunk, and an empty one has nothing to visit
+        HashTable ht2;
+        ht2.insert("only", 1);
+        anyErrors |= ht2.keys(8) != vector<string>{"only"} || HashTable().keys(8).size() != 0;
+        anyErrors |= HashTable().parallelReduce(7, [](string_view, int v) { return v; }, plus<int>(), 4) != 7;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: parallel scans agree with the serial ones for 1, 3 and 8 threads" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: a parallel scan disagreed *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST PARALLEL SCAN ***" << endl << endl;
+#endif
+
+    // TEST: COROUTINE LOOKUPS
+    OUTSTREAM << "Testing asyncGet() and interleaved getMany()" << endl;
+    OUTSTREAM << "--------------------------------------------" << endl;
+#ifdef HT_ASYNC_GET
+    try {
+        HashTable ht1;
+        const string longPrefix(40, 'L'); // long keys live outside the bucket
+        vector<string> queries;
+        for (int i = 0; i < 3000; i++) {
+            ht1.insert((i % 2 ? longPrefix : "") + "async" + to_string(i), i);
+            queries.push_back((i % 2 ? longPrefix : "") + "async" + to_string(i));
+            queries.push_back("missing" + to_string(i));
+        }
+        for (int i = 0; i < 3000; i += 5) ht1.remove(queries[2 * i]);
+        ht1.insertWithTtl("expired", 1, chrono::milliseconds(-1));
+        queries.push_back("expired");
+
+        bool anyErrors = false;
+        for (const size_t groupSize : {1, 4, 16, 100000}) {
+            const vector<optional<int>> results = ht1.getMany(queries, groupSize);
+            for (size_t q = 0; q < queries.size(); q++) anyErrors |= results[q] != ht1.get(queries[q]);
+        }
+        anyErrors |= ht1.asyncGet(queries[2]).run() != 1 || ht1.asyncGet("nope").run().has_value();
+        anyErrors |= !ht1.getMany({}, 8).empty();
+
+        // a task dropped mid-walk must clean up its frame
+        GetTask abandoned = ht1.asyncGet(queries[4]);
+        abandoned.resume();
+        abandoned = GetTask();
+        anyErrors |= static_cast<bool>(abandoned);
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: interleaved lookups match get() for group sizes 1 to 100000" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: an interleaved lookup disagreed with get() *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST ASYNC GET ***" << endl << endl;
+#endif
+
+    // TEST: MEMORY USAGE BREAKDOWN AND COMPACTION
+    OUTSTREAM << "Testing memoryUsage() and compact()" << endl;
+    OUTSTREAM << "-----------------------------------" << endl;
+#ifdef HT_MEMORY_USAGE
+    try {
+        CountingResource counter;
+        HashTable ht1(MAXHASH, &counter);
+        const string longPrefix(40, 'M'); // long keys live outside the bucket
+        for (int i = 0; i < 4000; i++) ht1.insert((i % 2 ? longPrefix : "") + "mem" + to_string(i), i);
+        ht1.enableFilter();
+        for (int i = 0; i < 4000; i += 4) ht1.remove((i % 2 ? longPrefix : "") + "mem" + to_string(i));
+        for (int i = 1; i < 4000; i += 4) ht1.remove(longPrefix + "mem" + to_string(i));
+
+        const HashTable::MemoryUsage before = ht1.memoryUsage();
+        const size_t inUseBefore = counter.bytesInUse();
+        bool anyErrors = before.total() != inUseBefore || before.tombstoneBytes == 0 || before.keyHeapBytes == 0;
+
+        const size_t capacityBefore = ht1.capacity();
+        ht1.compact();
+        const HashTable::MemoryUsage after = ht1.memoryUsage();
+        anyErrors |= after.total() != counter.bytesInUse() || after.tombstoneBytes != 0;
+        anyErrors |= ht1.capacity() >= capacityBefore || after.total() >= before.total();
+        anyErrors |= after.keyHeapBytes > before.keyHeapBytes || ht1.size() != 2000;
+        for (int i = 0; i < 4000; i++) {
+            const optional<int> value = ht1.get((i % 2 ? longPrefix : "") + "mem" + to_string(i));
+            anyErrors |= value.has_value() != (i % 4 >= 2) || (value && *value != i);
+        }
+
+        // the compacted table grows again as usual
+        for (int i = 0; i < 100; i++) ht1.insert(longPrefix + "more" + to_string(i), i);
+        anyErrors |= ht1.memoryUsage().total() != counter.bytesInUse() || ht1.size() != 2100;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: memoryUsage() matches the resource (" << inUseBefore << " -> "
+                    << after.total() << " bytes after compact())" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: memory breakdown or compact() is wrong *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST MEMORY USAGE ***" << endl << endl;
+#endif
+
+    // TEST: BULK REMOVAL
+    OUTSTREAM << "Testing eraseIf(), retain() and removeMany()" << endl;
+    OUTSTREAM << "--------------------------------------------" << endl;
+#ifdef HT_BULK_ERASE
+    try {
+        HashTable ht1;
+        for (int i = 0; i < 4000; i++) ht1.insert("bulk" + to_string(i), i);
+        ht1.insertWithTtl("expired", 7, chrono::milliseconds(-1));
+        ht1.enableFilter();
+        const HashTable before = ht1.snapshot();
+
+        bool anyErrors = ht1.eraseIf([](string_view, const int value) { return value % 3 == 0; }) != 1334;
+        anyErrors |= ht1.cacheStats().expirations != 1 || ht1.size() != 2666;
+        anyErrors |= ht1.retain([](const string_view key, int) { return key.back() != '1'; }) != 267;
+
+        vector<string> batch = {"bulk2", "bulk2", "bulk3", "missing"}; // a repeat, a removed key and a missing one
+        for (int i = 100; i < 4000; i++) batch.push_back("bulk" + to_string(i));
+        anyErrors |= ht1.removeMany(batch) != 2341 || ht1.size() != 58; // bulk2 plus every survivor past 99
+
+        // the sweeps left mostly tombstones, so the table compacted itself
+        anyErrors |= ht1.capacity() != 2 * ht1.size() || ht1.memoryUsage().tombstoneBytes != 0;
+        for (int i = 0; i < 100; i++) {
+            const bool kept = i % 3 != 0 && i % 10 != 1 && i != 2;
+            anyErrors |= ht1.get("bulk" + to_string(i)) != (kept ? optional<int>(i) : nullopt);
+        }
+        anyErrors |= before.size() != 4001 || before.get("bulk3") != 3; // the snapshot saw none of it
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: eraseIf(), retain() and removeMany() remove in one sweep and compact" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: bulk removal is wrong *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST BULK ERASE ***" << endl << endl;
+#endif
+
+    // TEST: TABLE SET OPERATIONS
+    OUTSTREAM << "Testing merge(), intersect(), difference() and reserve()" << endl;
+    OUTSTREAM << "--------------------------------------------------------" << endl;
+#ifdef HT_SET_OPERATIONS
+    try {
+        HashTable daily;
+        HashTable hourly;
+        for (int i = 0; i < 3000; i++) daily.insert("count" + to_string(i), i);
+        for (int i = 2000; i < 4000; i++) hourly.insert("count" + to_string(i), 1);
+        hourly.insertWithTtl("expired", 1, chrono::milliseconds(-1));
+        const auto plus = [](const int a, const int b) { return a + b; };
+
+        auto mergedMatches = [](const HashTable& merged) {
+            bool ok = merged.size() == 4000 && !merged.contains("expired");
+            for (int i = 0; i < 4000; i++) ok &= merged.get("count" + to_string(i)) == (i < 2000 ? i : i < 3000 ? i + 1 : 1);
+            return ok;
+        };
+        HashTable merged = daily;
+        merged.merge(hourly, plus);
+        bool anyErrors = !mergedMatches(merged);
+
+        // same capacity on both sides takes the lockstep path
+        HashTable reserved = hourly;
+        reserved.reserve(2 * daily.size());
+        HashTable lockstep = daily;
+        lockstep.reserve(2 * daily.size());
+        anyErrors |= lockstep.capacity() != reserved.capacity();
+        lockstep.merge(reserved, plus);
+        anyErrors |= !mergedMatches(lockstep);
+
+        HashTable shared = daily;
+        anyErrors |= shared.intersect(hourly) != 2000 || shared.size() != 1000 || shared.get("count2999") != 2999;
+        HashTable onlyDaily = daily;
+        anyErrors |= onlyDaily.difference(hourly) != 1000 || onlyDaily.size() != 2000 || onlyDaily.contains("count2000");
+        anyErrors |= daily.size() != 3000 || hourly.size() != 2001; // the operands are untouched
+
+        // moving from a table on the same resource takes over its keys' storage
+        CountingResource counter;
+        HashTable target(MAXHASH, &counter);
+        HashTable source(MAXHASH, &counter);
+        const string longPrefix(40, 'S');
+        for (int i = 0; i < 1000; i++) {
+            target.insert(longPrefix + "target" + to_string(i), i);
+            source.insert(longPrefix + "source" + to_string(i), i);
+        }
+        target.reserve(2000);
+        const size_t allocationsBefore = counter.allocations;
+        target.merge(std::move(source), plus);
+        anyErrors |= counter.allocations - allocationsBefore > 8 || target.size() != 2000 || source.size() != 0;
+        anyErrors |= target.get(longPrefix + "source999") != 999;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: merge(), intersect() and difference() match the naive loops" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: a set operation is wrong *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST SET OPERATIONS ***" << endl << endl;
+#endif
+
+    // TEST: MOVES, SWAP AND CLEAR
+    OUTSTREAM << "Testing noexcept moves, swap(), clear() and key-moving inserts" << endl;
+    OUTSTREAM << "--------------------------------------------------------------" << endl;
+#ifdef HT_MOVE_SEMANTICS
+    try {
+        static_assert(is_nothrow_move_constructible_v<HashTable> && is_nothrow_move_assignable_v<HashTable>);
+        static_assert(is_nothrow_swappable_v<HashTable> && is_nothrow_move_constructible_v<HashTableBucket>);
+
+        CountingResource counter;
+        HashTable ht1(1024, &counter); // large enough that no insert resizes
+        const string longPrefix(40, 'K'); // long keys live outside the bucket
+        vector<pmr::string> keys;
+        for (int i = 0; i < 100; i++) keys.emplace_back(longPrefix + to_string(i), &counter);
+
+        // moving keys from the table's resource in costs no allocation
+        size_t allocationsBefore = counter.allocations;
+        for (int i = 0; i < 100; i++) ht1.insert(std::move(keys[i]), i);
+        bool anyErrors = counter.allocations != allocationsBefore || ht1.size() != 100;
+        anyErrors |= ht1.get(longPrefix + "42") != 42;
+
+        // emplace() allocates each long key once, in the table's resource
+        allocationsBefore = counter.allocations;
+        for (int i = 100; i < 200; i++) ht1.emplace(longPrefix + to_string(i), i);
+        anyErrors |= counter.allocations - allocationsBefore != 100 || ht1.get(longPrefix + "150") != 150;
+        anyErrors |= ht1.emplace(longPrefix + "150", 0) || ht1.get(longPrefix + "150") != 150;
+
+        // swap exchanges contents and resources
+        HashTable ht2;
+        ht2.insert("other", 1);
+        swap(ht1, ht2);
+        anyErrors |= ht1.size() != 1 || ht2.size() != 200 || ht2.resource() != &counter || ht1.resource() == &counter;
+
+        // clear() keeps the capacity; pages fill in again on write
+        const size_t capacity = ht2.capacity();
+        ht2.clear();
+        anyErrors |= ht2.size() != 0 || ht2.capacity() != capacity || ht2.contains(longPrefix + "42");
+        anyErrors |= ht2.memoryUsage().total() != counter.bytesInUse();
+        for (int i = 0; i < 300; i++) ht2.insert("again" + to_string(i), i);
+        anyErrors |= ht2.size() != 300 || ht2.get("again299") != 299 || ht2.memoryUsage().total() != counter.bytesInUse();
+
+        // a moved-from table is an empty table that works as is, and again after clear()
+        HashTable moved = std::move(ht2);
+        anyErrors |= ht2.size() != 0 || moved.size() != 300 || moved.get("again7") != 7;
+        anyErrors |= ht2.contains("again7") || ht2.get("again7").has_value() || ht2.remove("again7");
+        anyErrors |= ht2.asyncGet("again7").run().has_value() || !ht2.keys().empty() || ht2.alpha() != 0.0;
+        ht2.insert("reused", 1);
+        anyErrors |= ht2.get("reused") != 1 || ht2.capacity() != HashTable::DEFAULT_INITIAL_CAPACITY;
+        HashTable movedAgain = std::move(ht2);
+        ht2.clear();
+        ht2["cleared"] += 2;
+        anyErrors |= ht2.get("cleared") != 2 || ht2.size() != 1 || movedAgain.get("reused") != 1;
+
+        // so is a moved-from OrderedHashTable, whose entries had moved to the heap
+        OrderedHashTable ordered;
+        for (int i = 0; i < 20; i++) ordered.insert("o" + to_string(i), i);
+        OrderedHashTable orderedMoved = std::move(ordered);
+        anyErrors |= ordered.size() != 0 || ordered.contains("o1") || !ordered.isInline() || orderedMoved.get("o19") != 19;
+        ordered.insert("back", 5);
+        anyErrors |= ordered.keys() != vector<string>{"back"} || ordered.get("back") != 5;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: moves, swap() and clear() allocate nothing extra" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: move semantics are wrong *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST MOVE SEMANTICS ***" << endl << endl;
+#endif
+
+    // TEST: INTEGER KEYS
+    OUTSTREAM << "Testing IntHashTable against std::map" << endl;
+    OUTSTREAM << "-------------------------------------" << endl;
+#ifdef HT_INT_KEYS
+    try {
+        IntHashTable ht1;
+        map<uint64_t, int> expected;
+        uint64_t state = 12345;
+        bool anyErrors = false;
+        for (int i = 0; i < 20000; i++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            const uint64_t key = i % 3 == 0 ? state >> 40 : state; // small keys collide more often
+            if (i % 5 == 4) {
+                anyErrors |= ht1.remove(key) != (expected.erase(key) == 1);
+            } else {
+                anyErrors |= ht1.insert(key, i) != expected.emplace(key, i).second;
+            }
+        }
+
+        // the keys that mark empty and removed slots are ordinary keys to callers
+        for (const uint64_t key : {~uint64_t{0}, ~uint64_t{0} - 1, uint64_t{0}}) {
+            anyErrors |= !ht1.insert(key, 7) || ht1.insert(key, 8) || ht1.get(key) != 7;
+            expected[key] = 7;
+        }
+        anyErrors |= !ht1.remove(~uint64_t{0}) || ht1.contains(~uint64_t{0});
+        expected.erase(~uint64_t{0});
+        ht1[static_cast<uint64_t>(-5)] += 3; // signed IDs convert
+        expected[static_cast<uint64_t>(-5)] += 3;
+
+        anyErrors |= ht1.size() != expected.size() || ht1.keys().size() != expected.size();
+        for (const auto& [key, value] : expected) anyErrors |= ht1.get(key) != value;
+        anyErrors |= (ht1.capacity() & (ht1.capacity() - 1)) != 0 || ht1.alpha() > 0.75;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: IntHashTable matches std::map over " << expected.size() << " keys" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: IntHashTable disagreed with std::map *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST INT KEYS ***" << endl << endl;
+#endif
+
+    // TEST: CONCURRENT ACCESSORS
+    OUTSTREAM << "Testing ConcurrentHashTable accessors with 4 threads" << endl;
+    OUTSTREAM << "----------------------------------------------------" << endl;
+#ifdef HT_CONCURRENT_ACCESSORS
+    try {
+        ConcurrentHashTable ht1;
+        const size_t threads = 4;
+        const int updates = 20000;
+        const vector<string> hot = {"hot:a", "hot:b", "hot:c"};
+        atomic<bool> anyErrors = false;
+
+        // every thread bumps the hot keys through accessors while inserting keys of its own, which forces resizes
+        vector<thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                for (int i = 0; i < updates; i++) {
+                    {
+                        ConcurrentHashTable::Accessor accessor;
+                        ht1.insert(accessor, hot[i % hot.size()]);
+                        ++*accessor;
+                    }
+                    if (i % 10 == 0) {
+                        const string own = "t" + to_string(t) + ":" + to_string(i);
+                        if (!ht1.insert(own, i) || ht1.get(own) != i) anyErrors = true;
+                    }
+                    if (i % 40 == 20 && !ht1.erase("t" + to_string(t) + ":" + to_string(i - 10))) anyErrors = true;
+                    if (i % 100 == 0) {
+                        ConcurrentHashTable::ConstAccessor reader;
+                        if (!ht1.find(reader, hot[0]) || reader.key() != hot[0] || *reader <= 0) anyErrors = true;
+                    }
+                }
+            });
+        }
+        for (thread& worker : workers) worker.join();
+
+        int hotTotal = 0;
+        for (const string& key : hot) hotTotal += ht1.get(key).value_or(0);
+        const size_t ownKeys = threads * (updates / 10 - updates / 40);
+        anyErrors = anyErrors || hotTotal != static_cast<int>(threads) * updates ||
+                    ht1.size() != hot.size() + ownKeys || ht1.keys().size() != ht1.size();
+
+        ConcurrentHashTable::Accessor accessor;
+        anyErrors = anyErrors || ht1.find(accessor, "missing") || !accessor.empty() || ht1.insert(accessor, hot[1]) ||
+                    accessor.key() != hot[1];
+        accessor.release();
+        anyErrors = anyErrors || !ht1.erase(hot[1]) || ht1.erase(hot[1]) || ht1.get(hot[1]).has_value();
+
+        // a thread may hold several accessors, and both it and other threads resize around them
+        ConcurrentHashTable ht2;
+        for (const string key : {"first", "second", "third"}) ht2.insert(key, 1);
+        ConcurrentHashTable::ConstAccessor first;
+        ConcurrentHashTable::Accessor second;
+        anyErrors = anyErrors || !ht2.find(first, "first") || !ht2.find(second, "second");
+        thread grower([&ht2] {
+            for (int i = 0; i < 1000; i++) ht2.insert("grown" + to_string(i), i);
+        });
+        ConcurrentHashTable::ConstAccessor third;
+        anyErrors = anyErrors || !ht2.find(third, "third") || *third != 1;
+        for (int i = 0; i < 1000; i++) {
+            anyErrors = anyErrors || !ht2.insert("held" + to_string(i), i) || ht2.get("held" + to_string(i)) != i;
+        }
+        grower.join();
+        ++*second;
+        anyErrors = anyErrors || ht2.capacity() < 2 * 2003 || first.key() != "first" || *third != 1;
+        first.release();
+        second.release();
+        third.release();
+        anyErrors = anyErrors || ht2.size() != 2003 || ht2.get("second") != 2 || ht2.get("grown999") != 999;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: " << threads << " threads made " << hotTotal << " accessor updates to hot keys across "
+                    << ht1.capacity() << " slots" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: ConcurrentHashTable lost or duplicated an update *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST CONCURRENT ACCESSORS ***" << endl << endl;
+#endif
+
+    // TEST: DELTA REPLICATION
+    OUTSTREAM << "Testing checkpoint(), exportDelta() and applyDelta()" << endl;
+    OUTSTREAM << "----------------------------------------------------" << endl;
+#ifdef HT_DELTA_REPLICATION
+    try {
+        HashTable primary;
+        HashTable replica;
+        for (int i = 0; i < 5000; i++) primary.insert("row:" + to_string(i), i);
+
+        // true if replica holds exactly the primary's entries, in the same layout
+        auto inSync = [&] {
+            bool same = replica.size() == primary.size() && replica.capacity() == primary.capacity();
+            for (const string& key : primary.keys()) same &= replica.get(key) == primary.get(key);
+            return same;
+        };
+
+        uint64_t since = primary.checkpoint();
+        const string full = primary.exportDelta(0);
+        replica.applyDelta(full);
+        bool anyErrors = !inSync();
+
+        for (int i = 0; i < 50; i++) {
+            primary["row:" + to_string(i * 97)] += 1000;
+            primary.remove("row:" + to_string(i * 89 + 1));
+            primary.insert("new:" + to_string(i), -i);
+        }
+        primary.insertWithTtl("session", 7, chrono::hours(1));
+        uint64_t next = primary.checkpoint();
+
+        // ship the delta through a file, as to a replica in another process
+        const string path = (filesystem::temp_directory_path() / "HashTableExtendedTests.delta").string();
+        ofstream(path, ios::binary | ios::trunc) << primary.exportDelta(since);
+        ifstream in(path, ios::binary);
+        const string delta((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        in.close();
+        filesystem::remove(path);
+        replica.applyDelta(delta);
+        since = next;
+        anyErrors |= !inSync() || replica.get("session") != 7 || delta.size() * 5 > full.size();
+
+        // a truncated image is rejected before the replica changes
+        try {
+            replica.applyDelta(string_view(delta).substr(0, delta.size() - 3));
+            anyErrors = true;
+        } catch (runtime_error&) {
+            anyErrors |= !inSync();
+        }
+        // and so is a full image whose capacity field disagrees with its runs or its length
+        const size_t capacityField = 24; // after magic, full flag and the two epochs
+        for (const uint64_t capacity : {uint64_t{0}, uint64_t{1} << 40, uint64_t{primary.capacity() + 1}}) {
+            string forged = full;
+            memcpy(forged.data() + capacityField, &capacity, sizeof(capacity));
+            try {
+                replica.applyDelta(forged);
+                anyErrors = true;
+            } catch (runtime_error&) {
+                anyErrors |= !inSync();
+            }
+        }
+        // so is a partial delta for a replica that never saw the full table
+        try {
+            HashTable fresh;
+            fresh.applyDelta(delta);
+            anyErrors = true;
+        } catch (invalid_argument&) {
+        }
+
+        // a resize moves every entry, so the next delta carries the whole table
+        for (int i = 5000; i < 20000; i++) primary.insert("row:" + to_string(i), i);
+        next = primary.checkpoint();
+        replica.applyDelta(primary.exportDelta(since));
+        since = next;
+        anyErrors |= !inSync();
+
+        const string quiet = primary.exportDelta(since);
+        replica.applyDelta(quiet);
+        anyErrors |= !inSync();
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: replica kept in sync; 151 writes sent in " << delta.size() << " bytes vs "
+                    << full.size() << " for the full table" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: replica diverged from the primary *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST DELTA REPLICATION ***" << endl << endl;
+#endif
+
+    // TEST: PROBE PATHS
+    OUTSTREAM << "Testing probePath() for stored and missing keys" << endl;
+    OUTSTREAM << "-----------------------------------------------" << endl;
+#ifdef HT_PROBE_PATH
+    try {
+        HashTable ht1;
+        for (int i = 0; i < 3000; i++) ht1.insert("probe:" + to_string(i), i);
+        for (int i = 0; i < 3000; i += 3) ht1.remove("probe:" + to_string(i));
+
+        // a stored key's path ends on its bucket, a missing key's on the ESS bucket that stopped get()
+        bool anyErrors = false;
+        size_t longest = 0;
+        for (int i = 0; i < 3000; i++) {
+            const vector<size_t> path = ht1.probePath("probe:" + to_string(i));
+            const BucketType last = ht1.bucketType(path.back());
+            anyErrors |= i % 3 == 0 ? last != BucketType::ESS : last != BucketType::NORMAL;
+            for (size_t step = 0; step + 1 < path.size(); step++) anyErrors |= ht1.bucketType(path[step]) == BucketType::ESS;
+            longest = max(longest, path.size());
+        }
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: probe paths end where get() stops (longest " << longest << " buckets)" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: probePath() disagrees with get() *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST PROBE PATH ***" << endl << endl;
+#endif
+
+    // TEST: INSERTION-ORDERED TABLE
+    OUTSTREAM << "Testing OrderedHashTable insertion order" << endl;
+    OUTSTREAM << "----------------------------------------" << endl;
+#ifdef HT_ORDERED
+    try {
+        OrderedHashTable ht1;
+        vector<pair<string, int>> expected; // live entries, oldest first
+        for (int i = 0; i < 5000; i++) {
+            ht1.insert("k" + to_string(i * 7919 % 5003), i);
+            expected.emplace_back("k" + to_string(i * 7919 % 5003), i);
+        }
+        bool anyErrors = ht1.insert("k0", 1) || ht1.capacity() < 7500;
+
+        // removals keep the order of what is left; a key inserted again goes last
+        for (int i = 0; i < 5000; i += 4) {
+            anyErrors |= !ht1.remove(expected[i].first);
+            expected[i].first.clear();
+        }
+        erase_if(expected, [](const pair<string, int>& entry) { return entry.first.empty(); });
+        anyErrors |= ht1.remove("k0") || !ht1.insert("k0", -1); // k0 was the first entry removed
+        expected.emplace_back("k0", -1);
+        ht1.insertOrAssign(expected[10].first, 99);
+        expected[10].second = 99;
+        ht1["late"] += 5;
+        expected.emplace_back("late", 5);
+        for (int i = 0; i < 20000; i++) {
+            ht1.insert("grow" + to_string(i), i); // several rebuilds
+            expected.emplace_back("grow" + to_string(i), i);
+        }
+
+        vector<pair<string, int>> seen;
+        ht1.forEach([&](const string_view key, const int value) { seen.emplace_back(string(key), value); });
+        const vector<string> keys = ht1.keys();
+        anyErrors |= seen != expected || ht1.size() != expected.size() || keys.size() != expected.size();
+        for (size_t i = 0; i < keys.size() && !anyErrors; i++) anyErrors |= keys[i] != expected[i].first;
+        for (const auto& [key, value] : expected) anyErrors |= ht1.get(key) != value;
+        anyErrors |= ht1.printMe().rfind("Entry 0: <" + expected[0].first + ", ", 0) != 0 || ht1.alpha() > 2.0 / 3;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: OrderedHashTable kept insertion order for " << ht1.size() << " keys over "
+                    << ht1.capacity() << " index slots" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: OrderedHashTable lost insertion order *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST ORDERED ***" << endl << endl;
+#endif
+
+    // TEST: INLINE STORAGE AND NARROW INDEX SLOTS
+    OUTSTREAM << "Testing OrderedHashTable inline storage and index widths" << endl;
+    OUTSTREAM << "--------------------------------------------------------" << endl;
+#ifdef HT_ORDERED_SMALL
+    try {
+        // up to 8 entries live in the table object; the index then widens 1 -> 2 -> 4 bytes a slot
+        OrderedHashTable ht1;
+        vector<pair<string, int>> expected;
+        bool anyErrors = !ht1.isInline() || ht1.indexWidth() != 1 || ht1.bytes() != sizeof(OrderedHashTable);
+        for (int i = 0; i < 8; i++) {
+            ht1.insert("s" + to_string(i), i);
+            expected.emplace_back("s" + to_string(i), i);
+        }
+        anyErrors |= !ht1.isInline() || ht1.bytes() != sizeof(OrderedHashTable);
+        anyErrors |= !ht1.remove("s3") || !ht1.insert("s3", 33); // a reinserted key still fits inline
+        erase_if(expected, [](const pair<string, int>& entry) { return entry.first == "s3"; });
+        expected.emplace_back("s3", 33);
+        anyErrors |= ht1.isInline() || ht1.capacity() != 16; // nine entries in use moved them to the heap
+
+        vector<size_t> widths{ht1.indexWidth()};
+        for (int i = 8; i < 100000; i++) {
+            ht1.insert("s" + to_string(i), i);
+            expected.emplace_back("s" + to_string(i), i);
+            if (ht1.indexWidth() != widths.back()) widths.push_back(ht1.indexWidth());
+        }
+        anyErrors |= widths != vector<size_t>{1, 2, 4} || ht1.alpha() > 2.0 / 3;
+
+        vector<pair<string, int>> seen;
+        ht1.forEach([&](const string_view key, const int value) { seen.emplace_back(string(key), value); });
+        anyErrors |= seen != expected;
+        for (const auto& [key, value] : expected) anyErrors |= ht1.get(key) != value;
+
+        OrderedHashTable ht2(64); // an initial capacity over 16 slots starts on the heap
+        anyErrors |= ht2.isInline() || ht2.indexWidth() != 1 || ht2.bytes() != sizeof(OrderedHashTable) + 64;
+
+        if (!anyErrors)
+            OUTSTREAM << "CORRECT: OrderedHashTable stayed inline to 8 entries and widened its index to "
+                    << ht1.indexWidth() << " bytes a slot" << endl << endl;
+        else
+            OUTSTREAM << "ERROR: OrderedHashTable small-table storage failed *** " << __LINE__ << endl << endl;
+    } catch (exception& e) {
+        OUTSTREAM << "Exception: " << e.what() << endl << endl;
+    }
+#else
+    OUTSTREAM << "*** DID NOT TEST ORDERED SMALL ***" << endl << endl;
+#endif
+
+    return 0;
+}
+#endif // RUN_TESTS
@@ -0,0 +1,413 @@
+/**
+ * HashTableProfile.cpp
+ *
+ * Profiles how a HashTable lays out a real key set, to help pick hash and
+ * probe policies. Loads a key file, one key per line, into a HashTable and
+ * reports the probe-length distribution of hits and misses, clusters of
+ * occupied and EAR buckets, home-bucket collisions under every available hash,
+ * and an estimate of the cache lines each lookup touches. Text output adds
+ * ASCII heatmaps of occupancy and probe length.
+ *
+ * Usage: HashTableProfile <key file> [--format text|csv|json] [--width columns] [--misses count]
+ */
+#include "HashFunctions.h"
+#include "HashTable.h"
+#include "KeyHash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+#define OUTSTREAM cout
+
+// counts of a non-negative quantity, such as a probe length
+struct Distribution {
+    map<size_t, size_t> counts;
+    size_t total = 0;
+    size_t sum = 0;
+
+    void add(const size_t value) {
+        counts[value]++;
+        total++;
+        sum += value;
+    }
+
+    [[nodiscard]] double mean() const {
+        return total == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(total);
+    }
+
+    [[nodiscard]] size_t percentile(const double p) const {
+        size_t seen = 0;
+        for (const auto& [value, count] : counts) {
+            seen += count;
+            if (static_cast<double>(seen) >= p * static_cast<double>(total)) return value;
+        }
+        return 0;
+    }
+
+    [[nodiscard]] size_t max() const {
+        return counts.empty() ? 0 : counts.rbegin()->first;
+    }
+};
+
+// how one hash function spreads the keys over home buckets
+struct HashCollisions {
+    string name;
+    bool used = false; // the hash this HashTable actually uses
+    size_t occupiedHomes = 0; // buckets that are home to at least one key
+    size_t collidingKeys = 0; // keys whose home bucket is already another key's home
+    size_t maxPerHome = 0;
+};
+
+// everything the tool reports
+struct Profile {
+    size_t keys = 0;
+    size_t duplicates = 0;
+    size_t size = 0;
+    size_t capacity = 0;
+    size_t tombstones = 0;
+    Distribution hitProbes; // buckets examined by get() of a stored key
+    Distribution missProbes; // buckets examined by get() of a missing key
+    Distribution clusters; // lengths of runs of consecutive NORMAL or EAR buckets
+    double hitLines = 0; // mean cache lines touched by a hit
+    double missLines = 0; // mean cache lines touched by a miss
+    double expectedColliding = 0; // colliding keys an ideal uniform hash would give
+    vector<HashCollisions> hashes;
+    vector<string> occupancyMap;
+    vector<string> probeMap;
+};
+
+const string RAMP = " .:-=+*#%@"; // heatmap characters, from lowest to highest
+
+/* Purpose: Picks the heatmap character for a level between 0 and 1.
+ */
+char rampChar(const double level) {
+    const double clamped = std::clamp(level, 0.0, 1.0);
+    return RAMP[static_cast<size_t>(clamped * static_cast<double>(RAMP.size() - 1) + 0.5)];
+}
+
+/* Purpose: Estimates the cache lines a lookup touches.
+ * Parameters:
+ *    path – buckets the lookup examines, from HashTable::probePath()
+ *    heapKey – true if the last bucket's key is compared and lives outside
+ *              the short-string buffer
+ * Returns:
+ *    size_t – 64-byte lines of the buckets, of the probe offsets read in
+ *    order, and of the key's heap storage
+ * Behavior:
+ *    Assumes each bucket page starts on a cache line, and that the key
+ *    bytes of other buckets are never read, since their stored hash differs.
+ */
+size_t cacheLines(const vector<size_t>& path, const bool heapKey) {
+    constexpr size_t LINE = 64;
+    size_t lines = (path.size() * sizeof(size_t) + LINE - 1) / LINE;
+    for (const size_t index : path) {
+        const size_t offset = index * sizeof(HashTableBucket);
+        lines += (offset + sizeof(HashTableBucket) - 1) / LINE - offset / LINE + 1;
+    }
+    return lines + heapKey;
+}
+
+/* Purpose: Counts home-bucket collisions of a hash over the keys.
+ * Parameters:
+ *    name – label for the report
+ *    hashFn – hash to test
+ *    keys – distinct keys
+ *    capacity – bucket count; homes are hash % capacity, as in HashTable
+ */
+HashCollisions countCollisions(const string& name, const function<uint64_t(string_view)>& hashFn,
+                               const vector<string>& keys, const size_t capacity) {
+    HashCollisions result;
+    result.name = name;
+    vector<uint32_t> perHome(capacity, 0);
+    for (const string& key : keys) {
+        uint32_t& count = perHome[hashFn(key) % capacity];
+        if (count == 0) {
+            result.occupiedHomes++;
+        } else {
+            result.collidingKeys++;
+        }
+        count++;
+        result.maxPerHome = std::max<size_t>(result.maxPerHome, count);
+    }
+    return result;
+}
+
+/* Purpose: Builds one heatmap, one character per group of buckets.
+ * Parameters:
+ *    capacity – bucket count
+ *    width – characters per row
+ *    level – level(first, last) between 0 and 1 for buckets [first, last)
+ * Returns:
+ *    vector<string> – the rows; at most 16 of them
+ */
+template <typename Level>
+vector<string> heatmap(const size_t capacity, const size_t width, Level&& level) {
+    const size_t cells = std::min(capacity, width * 16);
+    vector<string> rows;
+    for (size_t cell = 0; cell < cells; cell++) {
+        if (cell % width == 0) rows.emplace_back();
+        rows.back().push_back(rampChar(level(capacity * cell / cells, capacity * (cell + 1) / cells)));
+    }
+    return rows;
+}
+
+/* Purpose: Loads the keys into a table and measures it.
+ * Parameters:
+ *    lines – keys, in file order; repeated keys are counted and skipped
+ *    width – heatmap columns
+ *    misses – missing keys to look up, derived from the stored ones
+ */
+Profile profile(const vector<string>& lines, const size_t width, const size_t misses) {
+    Profile result;
+    HashTable table;
+    vector<string> keys;
+    for (const string& key : lines) {
+        if (table.insert(key, static_cast<int>(keys.size()))) {
+            keys.push_back(key);
+        } else {
+            result.duplicates++;
+        }
+    }
+    result.keys = lines.size();
+    result.size = table.size();
+    result.capacity = table.capacity();
+
+    const size_t shortKeyLimit = std::pmr::string().capacity(); // longer keys live on the heap
+    vector<double> probeSum(result.capacity, 0); // hit probe lengths by home bucket
+    vector<size_t> probeCount(result.capacity, 0);
+    size_t hitLines = 0;
+    for (const string& key : keys) {
+        const vector<size_t> path = table.probePath(key);
+        result.hitProbes.add(path.size());
+        hitLines += cacheLines(path, key.size() > shortKeyLimit);
+        const size_t home = HashTable::hash(key) % result.capacity;
+        probeSum[home] += static_cast<double>(path.size());
+        probeCount[home]++;
+    }
+    size_t missLines = 0;
+    for (size_t i = 0; i < misses && !keys.empty(); i++) {
+        const vector<size_t> path = table.probePath(keys[i % keys.size()] + "\x1f" + to_string(i));
+        result.missProbes.add(path.size());
+        missLines += cacheLines(path, false);
+    }
+    result.hitLines = keys.empty() ? 0 : static_cast<double>(hitLines) / static_cast<double>(keys.size());
+    result.missLines = misses == 0 ? 0 : static_cast<double>(missLines) / static_cast<double>(misses);
+
+    size_t run = 0;
+    for (size_t i = 0; i <= result.capacity; i++) {
+        const BucketType type = i < result.capacity ? table.bucketType(i) : BucketType::ESS;
+        if (type == BucketType::EAR) result.tombstones++;
+        if (type != BucketType::ESS) {
+            run++;
+        } else if (run > 0) {
+            result.clusters.add(run);
+            run = 0;
+        }
+    }
+
+    const double n = static_cast<double>(keys.size());
+    const double m = static_cast<double>(result.capacity);
+    result.expectedColliding = n - m * (1.0 - pow(1.0 - 1.0 / m, n));
+    const CpuLevel active = dispatchLevel();
+    for (const CpuLevel level : {CpuLevel::SCALAR, CpuLevel::SSE2, CpuLevel::SSE42, CpuLevel::AVX2, CpuLevel::AVX512,
+                                 CpuLevel::NEON}) {
+        if (!cpuLevelSupported(level)) continue;
+        result.hashes.push_back(countCollisions(string("keyHash/") + cpuLevelName(level), keyHashKernel(level), keys,
+                                                result.capacity));
+        result.hashes.back().used = level == active;
+    }
+    result.hashes.push_back(countCollisions("fnv1a64", [](const string_view key) { return fnv1a64(key); }, keys,
+                                            result.capacity));
+    result.hashes.push_back(countCollisions("mix64(fnv1a64)", [](const string_view key) { return mix64(fnv1a64(key)); },
+                                            keys, result.capacity));
+
+    result.occupancyMap = heatmap(result.capacity, width, [&](const size_t first, const size_t last) {
+        size_t used = 0;
+        for (size_t i = first; i < last; i++) used += table.bucketType(i) != BucketType::ESS;
+        return static_cast<double>(used) / static_cast<double>(last - first);
+    });
+    const double worst = std::max<double>(static_cast<double>(result.hitProbes.percentile(0.99)), 2.0);
+    result.probeMap = heatmap(result.capacity, width, [&](const size_t first, const size_t last) {
+        double sum = 0;
+        size_t count = 0;
+        for (size_t i = first; i < last; i++) {
+            sum += probeSum[i];
+            count += probeCount[i];
+        }
+        return count == 0 ? 0.0 : (sum / static_cast<double>(count) - 1.0) / (worst - 1.0);
+    });
+    return result;
+}
+
+/* Purpose: Prints the profile for a reader, with heatmaps.
+ */
+void printText(const Profile& p) {
+    OUTSTREAM << fixed << setprecision(2);
+    OUTSTREAM << "Keys " << p.keys << " (" << p.duplicates << " repeated), size " << p.size << ", capacity "
+            << p.capacity << ", load " << static_cast<double>(p.size) / static_cast<double>(p.capacity)
+            << ", EAR buckets " << p.tombstones << endl << endl;
+
+    for (const auto& [name, dist, lines] : {tuple<string, const Distribution&, double>{"hit", p.hitProbes, p.hitLines},
+                                            tuple<string, const Distribution&, double>{"miss", p.missProbes, p.missLines}}) {
+        OUTSTREAM << "Probe length, " << name << " (" << dist.total << " lookups): mean " << dist.mean() << ", p50 "
+                << dist.percentile(0.5) << ", p99 " << dist.percentile(0.99) << ", max " << dist.max()
+                << ", about " << lines << " cache lines" << endl;
+        for (const auto& [length, count] : dist.counts) {
+            const double share = static_cast<double>(count) / static_cast<double>(dist.total);
+            OUTSTREAM << "  " << setw(4) << length << setw(10) << count << "  "
+                    << string(static_cast<size_t>(share * 50 + 0.5), '#') << endl;
+        }
+        OUTSTREAM << endl;
+    }
+
+    OUTSTREAM << "Clusters of NORMAL/EAR buckets: " << p.clusters.total << ", mean length " << p.clusters.mean()
+            << ", p99 " << p.clusters.percentile(0.99) << ", max " << p.clusters.max() << endl << endl;
+
+    OUTSTREAM << "Home-bucket collisions (uniform hashing expects " << p.expectedColliding << " colliding keys)" << endl;
+    for (const HashCollisions& h : p.hashes) {
+        OUTSTREAM << "  " << left << setw(20) << h.name << right << setw(10) << h.collidingKeys << " colliding"
+                << setw(10) << h.occupiedHomes << " homes" << setw(6) << h.maxPerHome << " max"
+                << (h.used ? "  (in use)" : "") << endl;
+    }
+    OUTSTREAM << endl;
+
+    OUTSTREAM << "Occupancy by bucket range ('" << RAMP.front() << "' empty .. '" << RAMP.back() << "' full)" << endl;
+    for (const string& row : p.occupancyMap) OUTSTREAM << "  |" << row << "|" << endl;
+    OUTSTREAM << endl << "Mean hit probe length by home bucket ('" << RAMP.front() << "' 1 .. '" << RAMP.back()
+            << "' p99 or more)" << endl;
+    for (const string& row : p.probeMap) OUTSTREAM << "  |" << row << "|" << endl;
+}
+
+/* Purpose: Prints the profile as section,name,value rows.
+ */
+void printCsv(const Profile& p) {
+    OUTSTREAM << "section,name,value" << endl;
+    OUTSTREAM << "table,keys," << p.keys << endl << "table,repeated," << p.duplicates << endl;
+    OUTSTREAM << "table,size," << p.size << endl << "table,capacity," << p.capacity << endl;
+    OUTSTREAM << "table,ear_buckets," << p.tombstones << endl;
+    OUTSTREAM << "cache_lines,hit," << p.hitLines << endl << "cache_lines,miss," << p.missLines << endl;
+    for (const auto& [section, dist] : {pair<string, const Distribution&>{"hit_probe_length", p.hitProbes},
+                                        pair<string, const Distribution&>{"miss_probe_length", p.missProbes},
+                                        pair<string, const Distribution&>{"cluster_length", p.clusters}}) {
+        for (const auto& [length, count] : dist.counts) OUTSTREAM << section << "," << length << "," << count << endl;
+    }
+    OUTSTREAM << "collisions,uniform_expected," << p.expectedColliding << endl;
+    for (const HashCollisions& h : p.hashes) {
+        OUTSTREAM << "collisions," << h.name << (h.used ? " (in use)" : "") << "," << h.collidingKeys << endl;
+        OUTSTREAM << "max_per_home," << h.name << "," << h.maxPerHome << endl;
+    }
+    for (size_t r = 0; r < p.occupancyMap.size(); r++) OUTSTREAM << "occupancy_map," << r << ",|" << p.occupancyMap[r] << "|" << endl;
+    for (size_t r = 0; r < p.probeMap.size(); r++) OUTSTREAM << "probe_map," << r << ",|" << p.probeMap[r] << "|" << endl;
+}
+
+/* Purpose: Prints a distribution as a JSON object.
+ */
+void printJsonDistribution(const Distribution& dist) {
+    OUTSTREAM << "{\"count\": " << dist.total << ", \"mean\": " << dist.mean() << ", \"p50\": " << dist.percentile(0.5)
+            << ", \"p99\": " << dist.percentile(0.99) << ", \"max\": " << dist.max() << ", \"histogram\": {";
+    bool first = true;
+    for (const auto& [length, count] : dist.counts) {
+        OUTSTREAM << (first ? "" : ", ") << "\"" << length << "\": " << count;
+        first = false;
+    }
+    OUTSTREAM << "}}";
+}
+
+/* Purpose: Prints a list of heatmap rows as a JSON array.
+ */
+void printJsonRows(const vector<string>& rows) {
+    OUTSTREAM << "[";
+    for (size_t r = 0; r < rows.size(); r++) OUTSTREAM << (r == 0 ? "" : ", ") << "\"" << rows[r] << "\"";
+    OUTSTREAM << "]";
+}
+
+/* Purpose: Prints the profile as one JSON object.
+ */
+void printJson(const Profile& p) {
+    OUTSTREAM << "{" << endl;
+    OUTSTREAM << "  \"table\": {\"keys\": " << p.keys << ", \"repeated\": " << p.duplicates << ", \"size\": " << p.size
+            << ", \"capacity\": " << p.capacity << ", \"ear_buckets\": " << p.tombstones << "}," << endl;
+    OUTSTREAM << "  \"hit_probe_length\": ";
+    printJsonDistribution(p.hitProbes);
+    OUTSTREAM << "," << endl << "  \"miss_probe_length\": ";
+    printJsonDistribution(p.missProbes);
+    OUTSTREAM << "," << endl << "  \"cluster_length\": ";
+    printJsonDistribution(p.clusters);
+    OUTSTREAM << "," << endl << "  \"cache_lines\": {\"hit\": " << p.hitLines << ", \"miss\": " << p.missLines << "},"
+            << endl;
+    OUTSTREAM << "  \"collisions\": {\"uniform_expected\": " << p.expectedColliding << ", \"hashes\": [";
+    for (size_t i = 0; i < p.hashes.size(); i++) {
+        const HashCollisions& h = p.hashes[i];
+        OUTSTREAM << (i == 0 ? "" : ", ") << "{\"name\": \"" << h.name << "\", \"in_use\": " << (h.used ? "true" : "false")
+                << ", \"colliding_keys\": " << h.collidingKeys << ", \"occupied_homes\": " << h.occupiedHomes
+                << ", \"max_per_home\": " << h.maxPerHome << "}";
+    }
+    OUTSTREAM << "]}," << endl << "  \"occupancy_map\": ";
+    printJsonRows(p.occupancyMap);
+    OUTSTREAM << "," << endl << "  \"probe_map\": ";
+    printJsonRows(p.probeMap);
+    OUTSTREAM << endl << "}" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <key file> [--format text|csv|json] [--width columns] [--misses count]" << endl;
+        return 1;
+    }
+
+    string format = "text";
+    size_t width = 64;
+    size_t misses = 100000;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const string option = argv[i];
+        if (option == "--format") {
+            format = argv[i + 1];
+        } else if (option == "--width") {
+            width = std::max<size_t>(strtoul(argv[i + 1], nullptr, 10), 1);
+        } else if (option == "--misses") {
+            misses = strtoul(argv[i + 1], nullptr, 10);
+        } else {
+            cerr << "Unknown option " << option << endl;
+            return 1;
+        }
+    }
+    if (format != "text" && format != "csv" && format != "json") {
+        cerr << "Unknown format " << format << endl;
+        return 1;
+    }
+
+    ifstream in(argv[1]);
+    if (!in) {
+        cerr << "Cannot read " << argv[1] << endl;
+        return 1;
+    }
+    vector<string> lines;
+    for (string line; getline(in, line);) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        lines.push_back(std::move(line));
+    }
+
+    const Profile p = profile(lines, width, misses);
+    OUTSTREAM << fixed << setprecision(3);
+    if (format == "csv") {
+        printCsv(p);
+    } else if (format == "json") {
+        printJson(p);
+    } else {
+        printText(p);
+    }
+    return 0;
+}
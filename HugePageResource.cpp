@@ -0,0 +1,215 @@
+/* Filename: HugePageResource.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements HugePageResource, a memory resource
+ * for very large hash tables. Blocks at or above a size threshold (the bucket
+ * array and offsets of a big table) are mapped directly with mmap and backed by
+ * transparent (madvise) or explicit (MAP_HUGETLB) 2MB pages to cut TLB misses,
+ * and can be interleaved across NUMA nodes or bound to one node. Smaller blocks,
+ * such as key strings, are forwarded to an upstream resource. On systems without
+ * mmap, or when huge pages are unavailable, it falls back gracefully.
+ */
+
+#include "HugePageResource.h"
+#include <cstdint>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // mbind(2) policy values from <linux/mempolicy.h>; defined here so libnuma is not required
+    constexpr int MPOL_PREFERRED_MODE = 1;
+    constexpr int MPOL_BIND_MODE = 2;
+    constexpr int MPOL_INTERLEAVE_MODE = 3;
+    constexpr int MPOL_LOCAL_MODE = 4;
+    constexpr size_t MAX_NUMA_NODES = 64;
+}
+
+/* Purpose: Constructs a huge-page resource.
+ * Parameters:
+ *    mode – NONE (4KB pages), TRANSPARENT (madvise) or EXPLICIT (MAP_HUGETLB)
+ *    numaPolicy – NUMA placement applied to each large block
+ *    numaNode – node used when numaPolicy is BIND
+ *    threshold – minimum block size served by mmap
+ *    upstream – resource that serves blocks below the threshold
+ */
+HugePageResource::HugePageResource(const HugePageMode mode, const NumaPolicy numaPolicy, const int numaNode,
+                                   const size_t threshold, std::pmr::memory_resource* upstream)
+    : mode(mode), numaPolicy(numaPolicy), numaNode(numaNode), threshold(threshold), upstream(upstream) {
+}
+
+/* Purpose: Rounds a block size up to a whole number of huge pages.
+ * Parameters:
+ *    bytes – requested size
+ * Returns:
+ *    size_t – length of the mapping that backs the block
+ */
+size_t HugePageResource::mappingLength(const size_t bytes) const {
+    return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+/* Purpose: Applies the NUMA policy to a freshly mapped block.
+ * Parameters:
+ *    p – start of the mapping
+ *    length – length of the mapping
+ * Behavior:
+ *    Must run before the block is first touched. Failures (no NUMA support,
+ *    single-node machine) are ignored and leave the kernel's default policy.
+ */
+void HugePageResource::applyNumaPolicy(void* p, const size_t length) const {
+#if defined(__linux__) && defined(SYS_mbind)
+    unsigned long nodeMask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {};
+    int policy;
+
+    switch (numaPolicy) {
+        case NumaPolicy::INTERLEAVE:
+            policy = MPOL_INTERLEAVE_MODE;
+            for (unsigned long& word : nodeMask) word = ~0UL; // the kernel ignores nodes that do not exist
+            break;
+        case NumaPolicy::LOCAL:
+            policy = MPOL_LOCAL_MODE;
+            break;
+        case NumaPolicy::BIND:
+            if (numaNode < 0 || static_cast<size_t>(numaNode) >= MAX_NUMA_NODES) return;
+            policy = MPOL_BIND_MODE;
+            nodeMask[numaNode / (8 * sizeof(unsigned long))] |= 1UL << (numaNode % (8 * sizeof(unsigned long)));
+            break;
+        default:
+            return;
+    }
+
+    if (syscall(SYS_mbind, p, length, policy, policy == MPOL_LOCAL_MODE ? nullptr : nodeMask,
+                MAX_NUMA_NODES + 1, 0) != 0 && policy == MPOL_LOCAL_MODE) {
+        // kernels older than 3.8 lack MPOL_LOCAL; an empty preferred set means the same thing
+        syscall(SYS_mbind, p, length, MPOL_PREFERRED_MODE, nullptr, 0, 0);
+    }
+#else
+    (void) p;
+    (void) length;
+#endif
+}
+
+/* Purpose: Maps normal pages starting on a huge-page boundary.
+ * Parameters:
+ *    length – mapping length, a multiple of HUGE_PAGE_SIZE
+ * Returns:
+ *    void* – start of the mapping, aligned to HUGE_PAGE_SIZE
+ * Behavior:
+ *    mmap only promises 4KB alignment, which breaks larger requested
+ *    alignments and keeps transparent huge pages out of the first and last
+ *    partial 2MB ranges. Maps HUGE_PAGE_SIZE extra and unmaps the unaligned
+ *    head and the tail, so what is left is exactly [start, start + length)
+ *    and do_deallocate can unmap it as usual.
+ * Throws:
+ *    bad_alloc if the mapping fails
+ */
+void* HugePageResource::mapAligned(const size_t length) {
+#ifdef __linux__
+    void* raw = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) throw std::bad_alloc();
+
+    char* base = static_cast<char*>(raw);
+    char* start = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(base) + HUGE_PAGE_SIZE - 1) & ~uintptr_t{HUGE_PAGE_SIZE - 1});
+    const size_t head = static_cast<size_t>(start - base);
+    if (head > 0) munmap(base, head);
+    munmap(start + length, HUGE_PAGE_SIZE - head);
+    return start;
+#else
+    (void) length;
+    throw std::bad_alloc();
+#endif
+}
+
+/* Purpose: Allocates a block.
+ * Parameters:
+ *    bytes – requested size
+ *    alignment – requested alignment
+ * Returns:
+ *    void* – start of the block
+ * Behavior:
+ *    Small or over-aligned blocks go upstream. Large blocks are mapped with
+ *    MAP_HUGETLB in EXPLICIT mode; if the system has no reserved huge pages
+ *    the block falls back to a normal mapping, aligned to 2MB, with
+ *    MADV_HUGEPAGE. NONE mode sets MADV_NOHUGEPAGE so the block stays on
+ *    4KB pages. Either way the block is 2MB-aligned, which covers every
+ *    alignment not sent upstream.
+ * Throws:
+ *    bad_alloc if no memory can be mapped
+ */
+void* HugePageResource::do_allocate(const size_t bytes, const size_t alignment) {
+#ifdef __linux__
+    if (bytes < threshold || alignment > HUGE_PAGE_SIZE) {
+        return upstream->allocate(bytes, alignment);
+    }
+
+    const size_t length = mappingLength(bytes);
+    void* p = MAP_FAILED;
+
+    if (mode == HugePageMode::EXPLICIT) {
+        p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            m_explicitMappings++;
+        } else {
+            m_fallbackMappings++;
+        }
+    }
+
+    if (p == MAP_FAILED) {
+        p = mapAligned(length);
+#ifdef MADV_HUGEPAGE
+        madvise(p, length, mode == HugePageMode::NONE ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+#endif
+    }
+
+    applyNumaPolicy(p, length);
+    return p;
+#else
+    return upstream->allocate(bytes, alignment);
+#endif
+}
+
+/* Purpose: Releases a block.
+ * Parameters:
+ *    p – block returned by do_allocate
+ *    bytes – size passed to do_allocate
+ *    alignment – alignment passed to do_allocate
+ */
+void HugePageResource::do_deallocate(void* p, const size_t bytes, const size_t alignment) {
+#ifdef __linux__
+    if (bytes < threshold || alignment > HUGE_PAGE_SIZE) {
+        upstream->deallocate(p, bytes, alignment);
+        return;
+    }
+    munmap(p, mappingLength(bytes));
+#else
+    upstream->deallocate(p, bytes, alignment);
+#endif
+}
+
+/* Purpose: Compares two resources.
+ * Returns:
+ *    true only for the same object, since mappings cannot be freed elsewhere
+ */
+bool HugePageResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+/* Purpose: Returns how many blocks are backed by explicit huge pages.
+ * Returns:
+ *    size_t – number of MAP_HUGETLB mappings made
+ */
+size_t HugePageResource::explicitMappings() const {
+    return m_explicitMappings;
+}
+
+/* Purpose: Returns how many EXPLICIT requests fell back to normal pages.
+ * Returns:
+ *    size_t – number of failed MAP_HUGETLB attempts
+ */
+size_t HugePageResource::fallbackMappings() const {
+    return m_fallbackMappings;
+}
@@ -0,0 +1,48 @@
+/*
+ * HugePageResource.h
+ */
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+enum class HugePageMode {NONE, TRANSPARENT, EXPLICIT};
+
+enum class NumaPolicy {DEFAULT, INTERLEAVE, LOCAL, BIND};
+
+class HugePageResource : public std::pmr::memory_resource {
+    private:
+        HugePageMode mode; // page size requested for large blocks
+        NumaPolicy numaPolicy; // placement requested for large blocks
+        int numaNode; // node used by NumaPolicy::BIND
+        size_t threshold; // blocks smaller than this go to upstream
+        std::pmr::memory_resource* upstream; // resource for small blocks
+        size_t m_explicitMappings = 0; // blocks backed by MAP_HUGETLB pages
+        size_t m_fallbackMappings = 0; // blocks that could not get explicit huge pages
+
+        [[nodiscard]] size_t mappingLength(size_t bytes) const;
+
+        [[nodiscard]] static void* mapAligned(size_t length);
+
+        void applyNumaPolicy(void* p, size_t length) const;
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    public:
+        static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+        explicit HugePageResource(HugePageMode mode = HugePageMode::TRANSPARENT,
+                                  NumaPolicy numaPolicy = NumaPolicy::DEFAULT, int numaNode = 0,
+                                  size_t threshold = HUGE_PAGE_SIZE,
+                                  std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+        HugePageResource(const HugePageResource&) = delete;
+        HugePageResource& operator=(const HugePageResource&) = delete;
+
+        [[nodiscard]] size_t explicitMappings() const;
+
+        [[nodiscard]] size_t fallbackMappings() const;
+};
@@ -0,0 +1,299 @@
+/* Filename: IntHashTable.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements IntHashTable, a HashTable for 64-bit
+ * integer keys such as IDs, which would otherwise have to be turned into strings.
+ * Each slot is 16 bytes: the key and the value, with no BucketType, because two key
+ * values are reserved to mark empty and removed slots. The home slot comes from a
+ * multiply-xorshift mix of the key, and collisions are resolved by linear probing,
+ * so a lookup usually reads one cache line of four slots. The two reserved keys can
+ * still be stored; their values are kept beside the slot array.
+ */
+
+#include <bit>
+#include <iostream>
+#include <sstream>
+#include "IntHashTable.h"
+
+/* Purpose: Constructs an integer-key hash table with initial capacity.
+ * Parameters:
+ *    initCapacity – number of slots to initially create (defaults to 8);
+ *                   rounded up to a power of two of at least 8
+ */
+IntHashTable::IntHashTable(const size_t initCapacity) : m_capacity(DEFAULT_INITIAL_CAPACITY), m_size(0), m_tombstones(0) {
+    while (m_capacity < initCapacity) {
+        m_capacity *= 2;
+    }
+    m_shift = 64 - std::countr_zero(m_capacity);
+    slots.resize(m_capacity);
+}
+
+/* Purpose: Mixes a key so that sequential and strided IDs spread evenly.
+ * Parameters:
+ *    key – integer key
+ * Returns:
+ *    uint64_t – key folded with its high half, times 2^64 / golden ratio;
+ *    the top bits are the best mixed and pick the home slot
+ */
+uint64_t IntHashTable::mix(const uint64_t key) {
+    return (key ^ (key >> 32)) * 0x9e3779b97f4a7c15ULL;
+}
+
+/* Purpose: Maps a key to its home slot.
+ * Returns:
+ *    size_t – top log2(capacity) bits of mix(key)
+ */
+size_t IntHashTable::homeIndex(const uint64_t key) const {
+    return mix(key) >> m_shift;
+}
+
+/* Purpose: Finds the slot holding a key.
+ * Parameters:
+ *    key – key to find; must not be a reserved key
+ * Returns:
+ *    size_t – slot index, or NO_SLOT if the key is missing
+ * Behavior:
+ *    Walks forward from the home slot until the key or an empty slot.
+ *    Tombstones are walked over; the load limit keeps an empty slot around.
+ */
+size_t IntHashTable::findIndex(const uint64_t key) const {
+    for (size_t i = homeIndex(key);; i = (i + 1) & (m_capacity - 1)) {
+        const uint64_t slotKey = slots[i].key;
+        if (slotKey == key) return i;
+        if (slotKey == EMPTY_KEY) return NO_SLOT;
+    }
+}
+
+/* Purpose: Returns the side storage of a reserved key.
+ * Parameters:
+ *    key – any key
+ * Returns:
+ *    pointer to the key's optional value if key is EMPTY_KEY or
+ *    TOMBSTONE_KEY, nullptr for every other key
+ */
+std::optional<int>* IntHashTable::reservedValue(const uint64_t key) {
+    return key >= TOMBSTONE_KEY ? &reserved[key - TOMBSTONE_KEY] : nullptr;
+}
+
+/* Purpose: Const overload of reservedValue().
+ */
+const std::optional<int>* IntHashTable::reservedValue(const uint64_t key) const {
+    return key >= TOMBSTONE_KEY ? &reserved[key - TOMBSTONE_KEY] : nullptr;
+}
+
+/* Purpose: Moves every entry into a fresh slot array.
+ * Parameters:
+ *    newCapacity – power-of-two slot count
+ * Behavior:
+ *    Drops all tombstones.
+ */
+void IntHashTable::rehash(const size_t newCapacity) {
+    std::vector<Slot> oldSlots(newCapacity);
+    oldSlots.swap(slots);
+    m_capacity = newCapacity;
+    m_shift = 64 - std::countr_zero(m_capacity);
+    m_size = 0;
+    m_tombstones = 0;
+
+    for (const Slot& slot : oldSlots) {
+        if (slot.key < TOMBSTONE_KEY) placeNew(slot.key, slot.value);
+    }
+}
+
+/* Purpose: Stores a key known to be missing in the first empty slot of its run.
+ * Returns:
+ *    size_t – slot index used
+ */
+size_t IntHashTable::placeNew(const uint64_t key, const int value) {
+    size_t i = homeIndex(key);
+    while (slots[i].key != EMPTY_KEY) {
+        i = (i + 1) & (m_capacity - 1);
+    }
+    slots[i] = {key, value};
+    m_size++;
+    return i;
+}
+
+/* Purpose: Finds a key's value, inserting the key if it is missing.
+ * Parameters:
+ *    key – key to find or insert
+ *    value – value stored if the key is inserted
+ * Returns:
+ *    pair of a pointer to the key's value and whether the key was inserted
+ * Behavior:
+ *    Probes once, remembering the first tombstone to reuse. Only when a
+ *    new key would take an empty slot past 3/4 of the slots (tombstones
+ *    included) does it rehash, doubling the capacity unless tombstones
+ *    made up most of the load.
+ */
+std::pair<int*, bool> IntHashTable::findOrInsert(const uint64_t key, const int value) {
+    if (std::optional<int>* special = reservedValue(key)) {
+        const bool inserted = !special->has_value();
+        if (inserted) *special = value;
+        return {&**special, inserted};
+    }
+
+    size_t firstFree = NO_SLOT;
+    size_t i = homeIndex(key);
+    for (;; i = (i + 1) & (m_capacity - 1)) {
+        const uint64_t slotKey = slots[i].key;
+        if (slotKey == key) return {&slots[i].value, false};
+        if (slotKey == EMPTY_KEY) break;
+        if (slotKey == TOMBSTONE_KEY && firstFree == NO_SLOT) firstFree = i;
+    }
+
+    if (firstFree != NO_SLOT) {
+        m_tombstones--;
+    } else if ((m_size + m_tombstones + 1) * 4 > m_capacity * 3) {
+        size_t newCapacity = m_capacity;
+        while ((m_size + 1) * 2 > newCapacity) newCapacity *= 2;
+        rehash(newCapacity);
+        return {&slots[placeNew(key, value)].value, true};
+    } else {
+        firstFree = i;
+    }
+    slots[firstFree] = {key, value};
+    m_size++;
+    return {&slots[firstFree].value, true};
+}
+
+/* Purpose: Inserts a key-value pair into the hash table.
+ * Parameters:
+ *    key – integer key to insert; any integral type converts to it
+ *    value – integer value to associate with key
+ * Returns:
+ *    true if insertion succeeded, false if key already exists
+ */
+bool IntHashTable::insert(const uint64_t key, const int value) {
+    return findOrInsert(key, value).second;
+}
+
+/* Purpose: Removes a key-value pair from the hash table.
+ * Parameters:
+ *    key – integer key to remove
+ * Returns:
+ *    true if key was found and removed, false otherwise
+ * Behavior:
+ *    Leaves a tombstone, which a later insert may reuse.
+ */
+bool IntHashTable::remove(const uint64_t key) {
+    if (std::optional<int>* special = reservedValue(key)) {
+        const bool found = special->has_value();
+        special->reset();
+        return found;
+    }
+
+    const size_t index = findIndex(key);
+    if (index == NO_SLOT) return false;
+    slots[index].key = TOMBSTONE_KEY;
+    m_size--;
+    m_tombstones++;
+    return true;
+}
+
+/* Purpose: Checks whether the table contains a key.
+ * Parameters:
+ *    key – integer key to search
+ * Returns:
+ *    true if key exists, false otherwise
+ */
+bool IntHashTable::contains(const uint64_t key) const {
+    return get(key).has_value();
+}
+
+/* Purpose: Retrieves the value associated with a key.
+ * Parameters:
+ *    key – integer key to lookup
+ * Returns:
+ *    optional<int> containing value if key exists, nullopt otherwise
+ */
+std::optional<int> IntHashTable::get(const uint64_t key) const {
+    if (const std::optional<int>* special = reservedValue(key)) return *special;
+
+    const size_t index = findIndex(key);
+    if (index == NO_SLOT) return std::nullopt;
+    return slots[index].value;
+}
+
+/* Purpose: Returns all keys currently in the hash table.
+ * Returns:
+ *    vector<uint64_t> containing all keys, in slot order
+ */
+std::vector<uint64_t> IntHashTable::keys() const {
+    std::vector<uint64_t> keys;
+    keys.reserve(size());
+
+    for (const Slot& slot : slots) {
+        if (slot.key < TOMBSTONE_KEY) keys.push_back(slot.key);
+    }
+    for (size_t r = 0; r < reserved.size(); r++) {
+        if (reserved[r]) keys.push_back(TOMBSTONE_KEY + r);
+    }
+
+    return keys;
+}
+
+/* Purpose: Returns current load factor of the table.
+ * Returns:
+ *    double – ratio of entries in slots to slot capacity
+ */
+double IntHashTable::alpha() const {
+    return static_cast<double>(m_size) / static_cast<double>(m_capacity);
+}
+
+/* Purpose: Returns total number of slots in the table.
+ * Returns:
+ *    size_t – slot count, a power of two
+ */
+size_t IntHashTable::capacity() const {
+    return m_capacity;
+}
+
+/* Purpose: Returns number of key-value pairs in the table.
+ * Returns:
+ *    size_t – number of entries, including any reserved keys
+ */
+size_t IntHashTable::size() const {
+    return m_size + reserved[0].has_value() + reserved[1].has_value();
+}
+
+/* Purpose: Accesses value by key using bracket notation.
+ * Parameters:
+ *    key – integer key to access
+ * Returns:
+ *    reference to the value associated with the key
+ * Behavior:
+ *    A missing key is inserted with value 0, like HashTable::operator[].
+ */
+int& IntHashTable::operator[](const uint64_t key) {
+    return *findOrInsert(key, 0).first;
+}
+
+/* Purpose: Prints the hash table to an output stream.
+ * Parameters:
+ *    os – output stream (e.g., cout)
+ * Behavior:
+ *    Prints all occupied slots in formatted form.
+ */
+std::ostream& operator<<(std::ostream& os, const IntHashTable& table) {
+    os << table.printMe();
+    return os;
+}
+
+/* Purpose: Returns a string representation of the hash table.
+ * Returns:
+ *    string – one line per occupied slot, then the reserved keys
+ */
+std::string IntHashTable::printMe() const {
+    std::ostringstream out;
+
+    for (size_t i = 0; i < m_capacity; i++) {
+        if (slots[i].key < TOMBSTONE_KEY) {
+            out << "Slot " << i << ": <" << slots[i].key << ", " << slots[i].value << ">\n";
+        }
+    }
+    for (size_t r = 0; r < reserved.size(); r++) {
+        if (reserved[r]) out << "Reserved: <" << TOMBSTONE_KEY + r << ", " << *reserved[r] << ">\n";
+    }
+
+    return out.str();
+}
@@ -0,0 +1,74 @@
+/*
+ * IntHashTable.h
+ */
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class IntHashTable {
+    private:
+        static constexpr uint64_t EMPTY_KEY = ~uint64_t{0}; // marks a never-used slot
+        static constexpr uint64_t TOMBSTONE_KEY = EMPTY_KEY - 1; // marks a slot whose key was removed
+        static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+        // key and value in 16 bytes, four slots per cache line; the key doubles as the slot state
+        struct alignas(16) Slot {
+            uint64_t key = EMPTY_KEY;
+            int value = 0;
+        };
+        static_assert(sizeof(Slot) == 16);
+
+        size_t m_capacity; // number of slots, a power of two
+        size_t m_size; // entries stored in slots
+        size_t m_tombstones; // TOMBSTONE_KEY slots
+        unsigned m_shift; // 64 - log2(m_capacity), so the top bits of mix() pick the home slot
+        std::vector<Slot> slots;
+        std::array<std::optional<int>, 2> reserved; // values of the keys EMPTY_KEY and TOMBSTONE_KEY themselves
+
+        [[nodiscard]] size_t homeIndex(uint64_t key) const;
+
+        [[nodiscard]] size_t findIndex(uint64_t key) const;
+
+        [[nodiscard]] std::optional<int>* reservedValue(uint64_t key);
+
+        [[nodiscard]] const std::optional<int>* reservedValue(uint64_t key) const;
+
+        void rehash(size_t newCapacity);
+
+        size_t placeNew(uint64_t key, int value);
+
+        std::pair<int*, bool> findOrInsert(uint64_t key, int value);
+
+    public:
+        static constexpr size_t DEFAULT_INITIAL_CAPACITY = 8;
+
+        [[nodiscard]] static uint64_t mix(uint64_t key);
+
+        IntHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY); // default constructor
+
+        bool insert(uint64_t key, int value);
+
+        bool remove(uint64_t key);
+
+        [[nodiscard]] bool contains(uint64_t key) const;
+
+        [[nodiscard]] std::optional<int> get(uint64_t key) const;
+
+        [[nodiscard]] std::vector<uint64_t> keys() const;
+
+        [[nodiscard]] double alpha() const;
+
+        [[nodiscard]] size_t capacity() const;
+
+        [[nodiscard]] size_t size() const;
+
+        int& operator[](uint64_t key);
+
+        friend std::ostream& operator<<(std::ostream& os, const IntHashTable& hashTable);
+
+        [[nodiscard]] std::string printMe() const;
+};
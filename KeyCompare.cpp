@@ -0,0 +1,195 @@
+/* Filename: KeyCompare.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements the key-equality kernels used when
+ * a probe lands on a bucket whose length and stored hash already match. Besides
+ * the scalar memcmp kernel there are SSE2, AVX2 and AVX-512 kernels on x86 and
+ * a NEON kernel on AArch64, comparing 16 to 64 bytes per step. The kernel is
+ * picked by CpuDispatch, so one binary runs everywhere.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "KeyCompare.h"
+
+#if defined(CPU_DISPATCH_X86)
+#include <immintrin.h>
+#elif defined(CPU_DISPATCH_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+/* Purpose: Compares two equal-length keys with memcmp.
+ */
+bool compareScalar(const char* a, const char* b, const size_t length) {
+    return std::memcmp(a, b, length) == 0;
+}
+
+#ifdef CPU_DISPATCH_X86
+/* Purpose: Returns the bytes that differ between 16 bytes at a and b.
+ */
+CPU_TARGET("sse2")
+__m128i diffSse2(const char* a, const char* b) {
+    return _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)),
+                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+}
+
+/* Purpose: Checks whether a diff vector has any nonzero byte.
+ */
+CPU_TARGET("sse2")
+bool anySse2(const __m128i diff) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xffff;
+}
+
+/* Purpose: Compares two equal-length keys 16 bytes per step.
+ * Behavior:
+ *    Long keys are checked 64 bytes per branch. The last step reloads the
+ *    final 16 bytes, overlapping the previous step, instead of finishing
+ *    byte by byte.
+ */
+CPU_TARGET("sse2")
+bool compareSse2(const char* a, const char* b, const size_t length) {
+    if (length < 16) return compareScalar(a, b, length);
+
+    size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        const __m128i diff = _mm_or_si128(_mm_or_si128(diffSse2(a + i, b + i), diffSse2(a + i + 16, b + i + 16)),
+                                          _mm_or_si128(diffSse2(a + i + 32, b + i + 32),
+                                                       diffSse2(a + i + 48, b + i + 48)));
+        if (anySse2(diff)) return false;
+    }
+    for (; i + 16 < length; i += 16) {
+        if (anySse2(diffSse2(a + i, b + i))) return false;
+    }
+    return i == length || !anySse2(diffSse2(a + length - 16, b + length - 16));
+}
+
+/* Purpose: Returns the bytes that differ between 32 bytes at a and b.
+ */
+CPU_TARGET("avx2")
+__m256i diffAvx2(const char* a, const char* b) {
+    return _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)));
+}
+
+/* Purpose: Checks whether a diff vector has any nonzero byte.
+ */
+CPU_TARGET("avx2")
+bool anyAvx2(const __m256i diff) {
+    return !_mm256_testz_si256(diff, diff);
+}
+
+/* Purpose: Compares two equal-length keys 32 bytes per step.
+ * Behavior:
+ *    Keys shorter than 32 bytes use the SSE2 kernel. Long keys are checked
+ *    128 bytes per branch, and the tail with one overlapping 32-byte step.
+ */
+CPU_TARGET("avx2")
+bool compareAvx2(const char* a, const char* b, const size_t length) {
+    if (length < 32) return compareSse2(a, b, length);
+
+    size_t i = 0;
+    for (; i + 128 <= length; i += 128) {
+        const __m256i diff = _mm256_or_si256(
+            _mm256_or_si256(diffAvx2(a + i, b + i), diffAvx2(a + i + 32, b + i + 32)),
+            _mm256_or_si256(diffAvx2(a + i + 64, b + i + 64), diffAvx2(a + i + 96, b + i + 96)));
+        if (anyAvx2(diff)) return false;
+    }
+    for (; i + 32 < length; i += 32) {
+        if (anyAvx2(diffAvx2(a + i, b + i))) return false;
+    }
+    return i == length || !anyAvx2(diffAvx2(a + length - 32, b + length - 32));
+}
+
+/* Purpose: Compares two equal-length keys 64 bytes per step.
+ * Behavior:
+ *    The tail, and any key shorter than 64 bytes, is read with one masked
+ *    load, so no byte past either key is touched.
+ */
+CPU_TARGET("avx512f,avx512bw")
+bool compareAvx512(const char* a, const char* b, const size_t length) {
+    size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        const __m512i x = _mm512_loadu_si512(a + i);
+        const __m512i y = _mm512_loadu_si512(b + i);
+        if (_mm512_cmpneq_epi8_mask(x, y) != 0) return false;
+    }
+    if (i == length) return true;
+
+    const __mmask64 tail = (uint64_t{1} << (length - i)) - 1; // length - i < 64
+    const __m512i x = _mm512_maskz_loadu_epi8(tail, a + i);
+    const __m512i y = _mm512_maskz_loadu_epi8(tail, b + i);
+    return _mm512_cmpneq_epi8_mask(x, y) == 0;
+}
+#endif
+
+#ifdef CPU_DISPATCH_NEON
+/* Purpose: Checks whether 16 bytes at a and b differ.
+ */
+bool differNeon(const char* a, const char* b) {
+    const uint8x16_t x = vld1q_u8(reinterpret_cast<const uint8_t*>(a));
+    const uint8x16_t y = vld1q_u8(reinterpret_cast<const uint8_t*>(b));
+    return vmaxvq_u8(veorq_u8(x, y)) != 0;
+}
+
+/* Purpose: Compares two equal-length keys 16 bytes per step with NEON.
+ */
+bool compareNeon(const char* a, const char* b, const size_t length) {
+    if (length < 16) return compareScalar(a, b, length);
+
+    for (size_t i = 0; i + 16 < length; i += 16) {
+        if (differNeon(a + i, b + i)) return false;
+    }
+    return !differNeon(a + length - 16, b + length - 16);
+}
+#endif
+
+} // namespace
+
+/* Purpose: Returns the key compare kernel of a level, e.g. to test or benchmark it.
+ * Parameters:
+ *    level – kernel level
+ * Returns:
+ *    KeyCompareFn – compares two keys of the given, equal length
+ * Behavior:
+ *    SSE4.2 adds nothing to equality tests, so it shares the SSE2 kernel.
+ *    Throws std::invalid_argument if the level cannot run on this machine.
+ */
+KeyCompareFn keyCompareKernel(const CpuLevel level) {
+    if (!cpuLevelSupported(level)) {
+        throw std::invalid_argument(std::string("unsupported key compare kernel: ") + cpuLevelName(level));
+    }
+    switch (level) {
+#ifdef CPU_DISPATCH_X86
+        case CpuLevel::SSE2:
+        case CpuLevel::SSE42:
+            return compareSse2;
+        case CpuLevel::AVX2:
+            return compareAvx2;
+        case CpuLevel::AVX512:
+            return compareAvx512;
+#endif
+#ifdef CPU_DISPATCH_NEON
+        case CpuLevel::NEON:
+            return compareNeon;
+#endif
+        default:
+            return compareScalar;
+    }
+}
+
+/* Purpose: Compares two keys for equality.
+ * Parameters:
+ *    a, b – keys to compare
+ * Returns:
+ *    true if both keys hold the same bytes
+ */
+bool keysEqual(const std::string_view a, const std::string_view b) {
+    static const KeyCompareFn kernel = keyCompareKernel(dispatchLevel());
+
+    if (a.size() != b.size()) return false;
+    if (a.size() < 16) return compareScalar(a.data(), b.data(), a.size());
+    return kernel(a.data(), b.data(), a.size());
+}
@@ -0,0 +1,18 @@
+/*
+ * KeyCompare.h
+ */
+#pragma once
+#include <cstddef>
+#include <string_view>
+#include "CpuDispatch.h"
+
+using KeyCompareFn = bool (*)(const char* a, const char* b, size_t length);
+
+[[nodiscard]] KeyCompareFn keyCompareKernel(CpuLevel level);
+
+/* Purpose: Compares two keys with the kernel of dispatchLevel().
+ * Behavior:
+ *    Lengths are checked first, so the kernel only ever sees equal-length
+ *    keys. Keys shorter than 16 bytes go straight to memcmp.
+ */
+[[nodiscard]] bool keysEqual(std::string_view a, std::string_view b);
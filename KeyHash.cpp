@@ -0,0 +1,112 @@
+/* Filename: KeyHash.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements the 64-bit key hash kernels behind
+ * HashTable. The scalar kernel is FNV-1a followed by the fmix64 finalizer,
+ * one byte per step. On x86-64 CPUs with SSE4.2, the hardware CRC32C
+ * instruction hashes 16 bytes per step in two independent lanes instead, and
+ * keys of up to 8 bytes are only finalized.
+ * CpuDispatch picks the kernel at run time.
+ */
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "HashFunctions.h"
+#include "KeyHash.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define KEY_HASH_CRC32 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/* Purpose: Hashes a key one byte at a time.
+ */
+uint64_t hashScalar(const std::string_view key) {
+    return mix64(fnv1a64(key));
+}
+
+#ifdef KEY_HASH_CRC32
+/* Purpose: Reads 8 unaligned bytes.
+ */
+uint64_t load64(const char* p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+/* Purpose: Hashes a key with CRC32C, 16 bytes per step.
+ * Behavior:
+ *    Even and odd 8-byte words feed two CRC lanes, so the two crc32
+ *    instructions of a step run in parallel. The zero-padded tail goes to
+ *    the second lane. The key length is mixed in so keys that differ only
+ *    in trailing zero bytes do not collide. fmix64 then spreads the two
+ *    32-bit lanes over all 64 bits. A key of 8 bytes or less would feed
+ *    only one lane, leaving 32 bits of entropy, so its zero-padded word
+ *    goes straight to fmix64 instead; that keeps every bit of it.
+ */
+CPU_TARGET("sse4.2")
+uint64_t hashCrc32(const std::string_view key) {
+    const char* p = key.data();
+    size_t remaining = key.size();
+    if (remaining <= 8) {
+        uint64_t word = 0;
+        if (remaining > 0) std::memcpy(&word, p, remaining);
+        return mix64(word ^ ((key.size() + 1) * 0x9e3779b97f4a7c15ULL)); // + 1 keeps the empty key off mix64(0) = 0
+    }
+
+    uint64_t a = 0x9e3779b9;
+    uint64_t b = 0x85ebca6b;
+
+    for (; remaining >= 16; p += 16, remaining -= 16) {
+        a = _mm_crc32_u64(a, load64(p));
+        b = _mm_crc32_u64(b, load64(p + 8));
+    }
+    if (remaining >= 8) {
+        a = _mm_crc32_u64(a, load64(p));
+        p += 8;
+        remaining -= 8;
+    }
+    if (remaining > 0) {
+        uint64_t tail = 0;
+        std::memcpy(&tail, p, remaining);
+        b = _mm_crc32_u64(b, tail);
+    }
+    return mix64(((a << 32) | b) ^ (key.size() * 0x9e3779b97f4a7c15ULL));
+}
+#endif
+
+} // namespace
+
+/* Purpose: Returns the hash kernel of a level, e.g. to test or benchmark it.
+ * Parameters:
+ *    level – kernel level
+ * Returns:
+ *    KeyHashFn – the level's hash function
+ * Behavior:
+ *    Levels from SSE4.2 up share the CRC32C kernel on x86-64; every other
+ *    level uses the scalar kernel. Throws std::invalid_argument if the
+ *    level cannot run on this machine.
+ */
+KeyHashFn keyHashKernel(const CpuLevel level) {
+    if (!cpuLevelSupported(level)) {
+        throw std::invalid_argument(std::string("unsupported key hash kernel: ") + cpuLevelName(level));
+    }
+#ifdef KEY_HASH_CRC32
+    if (level == CpuLevel::SSE42 || level == CpuLevel::AVX2 || level == CpuLevel::AVX512) return hashCrc32;
+#endif
+    return hashScalar;
+}
+
+/* Purpose: Hashes a key.
+ * Parameters:
+ *    key – bytes to hash
+ * Returns:
+ *    uint64_t – well-mixed hash; callers take low bits for an index and
+ *    high bits for a tag
+ */
+uint64_t keyHash(const std::string_view key) {
+    static const KeyHashFn kernel = keyHashKernel(dispatchLevel());
+    return kernel(key);
+}
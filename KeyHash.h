@@ -0,0 +1,18 @@
+/*
+ * KeyHash.h
+ */
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include "CpuDispatch.h"
+
+using KeyHashFn = uint64_t (*)(std::string_view key);
+
+[[nodiscard]] KeyHashFn keyHashKernel(CpuLevel level);
+
+/* Purpose: Hashes a key with the kernel of dispatchLevel().
+ * Behavior:
+ *    Different kernels give different hashes for the same key, so a hash
+ *    must never outlive the process that computed it.
+ */
+[[nodiscard]] uint64_t keyHash(std::string_view key);
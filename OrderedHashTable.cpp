@@ -0,0 +1,475 @@
+/* Filename: OrderedHashTable.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements OrderedHashTable, a hash table that
+ * keeps its entries in insertion order, in the style of Python's dict. Entries
+ * live in a dense array, appended as they are inserted; the hash table proper is
+ * a sparse index of positions into that array, probed linearly. keys(), forEach()
+ * and printMe() therefore return entries oldest first, the same way on every run
+ * and after every resize, and scan no empty slots. A resize rebuilds only the
+ * index from the hashes stored in the entries; no key is moved or hashed again.
+ * Removed entries stay in the array until the next rebuild compacts it.
+ * Small tables cost no heap allocation: the first INLINE_ENTRIES entries and an
+ * index of INLINE_SLOTS one-byte slots live inside the table object. A larger
+ * index uses 8-, 16- or 32-bit slots, whichever is the narrowest that can hold
+ * every position, so the index of a table under 170 entries is one byte a slot.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <type_traits>
+#include "KeyCompare.h"
+#include "KeyHash.h"
+#include "OrderedHashTable.h"
+
+namespace {
+
+template <typename Slot>
+constexpr Slot EMPTY_SLOT = std::numeric_limits<Slot>::max(); // index slot never used
+
+template <typename Slot>
+constexpr Slot DUMMY_SLOT = std::numeric_limits<Slot>::max() - 1; // index slot whose entry was removed
+
+} // namespace
+
+/* Purpose: Calls fn with a pointer to the index slots, typed by their width.
+ * Returns:
+ *    whatever fn returns, which must not depend on the width
+ */
+template <typename Fn>
+decltype(auto) OrderedHashTable::withIndex(Fn&& fn) {
+    if (m_slots <= INLINE_SLOTS) return fn(inlineIndex.data());
+    return std::visit([&fn](auto& slots) -> decltype(auto) { return fn(slots.data()); }, heapIndex);
+}
+
+/* Purpose: Const overload of withIndex().
+ */
+template <typename Fn>
+decltype(auto) OrderedHashTable::withIndex(Fn&& fn) const {
+    if (m_slots <= INLINE_SLOTS) return fn(inlineIndex.data());
+    return std::visit([&fn](const auto& slots) -> decltype(auto) { return fn(slots.data()); }, heapIndex);
+}
+
+/* Purpose: Constructs an ordered hash table with initial capacity.
+ * Parameters:
+ *    initCapacity – number of index slots to initially create (defaults to
+ *                   16); rounded up to a power of two of at least 16
+ * Behavior:
+ *    Allocates nothing unless initCapacity is over INLINE_SLOTS.
+ */
+OrderedHashTable::OrderedHashTable(const size_t initCapacity) : m_slots(INLINE_SLOTS) {
+    size_t slots = INLINE_SLOTS;
+    while (slots < initCapacity) {
+        slots *= 2;
+    }
+    allocateIndex(slots);
+}
+
+/* Purpose: Moves an ordered hash table.
+ * Parameters:
+ *    other – table to move from
+ * Behavior:
+ *    Takes over other's heap index and entries; inline ones are moved
+ *    across. other is left an empty inline table, ready for use.
+ */
+OrderedHashTable::OrderedHashTable(OrderedHashTable&& other) noexcept
+    : inlineIndex(other.inlineIndex), heapIndex(std::move(other.heapIndex)),
+      inlineEntries(std::move(other.inlineEntries)), heapEntries(std::move(other.heapEntries)),
+      m_slots(other.m_slots), m_entryCount(other.m_entryCount), m_size(other.m_size),
+      m_entriesInline(other.m_entriesInline) {
+    other.resetInline();
+}
+
+/* Purpose: Move-assigns an ordered hash table.
+ * Parameters:
+ *    other – table to move from
+ * Returns:
+ *    reference to this table
+ */
+OrderedHashTable& OrderedHashTable::operator=(OrderedHashTable&& other) noexcept {
+    if (this != &other) {
+        std::destroy_at(this);
+        std::construct_at(this, std::move(other));
+    }
+    return *this;
+}
+
+/* Purpose: Empties the table back to its allocation-free starting state.
+ * Behavior:
+ *    Frees the heap index and heap entries; only used on a moved-from
+ *    table, whose entries are already moved out.
+ */
+void OrderedHashTable::resetInline() noexcept {
+    m_slots = INLINE_SLOTS;
+    inlineIndex.fill(EMPTY_SLOT<uint8_t>);
+    heapIndex.emplace<std::vector<uint8_t>>();
+    std::vector<Entry>().swap(heapEntries);
+    for (Entry& entry : inlineEntries) entry = Entry{};
+    m_entryCount = 0;
+    m_size = 0;
+    m_entriesInline = true;
+}
+
+/* Purpose: Returns the entry array, wherever it currently lives.
+ */
+OrderedHashTable::Entry* OrderedHashTable::entryData() {
+    return m_entriesInline ? inlineEntries.data() : heapEntries.data();
+}
+
+/* Purpose: Const overload of entryData().
+ */
+const OrderedHashTable::Entry* OrderedHashTable::entryData() const {
+    return m_entriesInline ? inlineEntries.data() : heapEntries.data();
+}
+
+/* Purpose: Replaces the index with an empty one.
+ * Parameters:
+ *    slots – power-of-two slot count
+ * Behavior:
+ *    Up to INLINE_SLOTS slots use the inline array and free any heap
+ *    index. Larger indexes get one-byte slots up to 256 slots and two-byte
+ *    slots up to 65536, since the 2/3 load limit keeps every position
+ *    below the two values reserved for empty and removed slots; past
+ *    that, slots are four bytes.
+ */
+void OrderedHashTable::allocateIndex(const size_t slots) {
+    m_slots = slots;
+    if (slots <= INLINE_SLOTS) {
+        inlineIndex.fill(EMPTY_SLOT<uint8_t>);
+        heapIndex = std::vector<uint8_t>();
+    } else if (slots <= 256) {
+        heapIndex = std::vector<uint8_t>(slots, EMPTY_SLOT<uint8_t>);
+    } else if (slots <= 65536) {
+        heapIndex = std::vector<uint16_t>(slots, EMPTY_SLOT<uint16_t>);
+    } else {
+        heapIndex = std::vector<uint32_t>(slots, EMPTY_SLOT<uint32_t>);
+    }
+}
+
+/* Purpose: Finds the index slot pointing at a key's entry.
+ * Parameters:
+ *    key – key to find
+ *    keyHash – keyHash(key)
+ * Returns:
+ *    size_t – index slot, or NO_SLOT if the key is missing
+ * Behavior:
+ *    Walks forward from the home slot until the key or an empty slot,
+ *    comparing stored hashes before keys. Slots of removed entries are
+ *    walked over.
+ */
+size_t OrderedHashTable::findSlot(const std::string_view key, const uint64_t keyHash) const {
+    const Entry* entries = entryData();
+    const size_t mask = m_slots - 1;
+
+    return withIndex([&](const auto* index) {
+        using Slot = std::remove_cv_t<std::remove_pointer_t<decltype(index)>>;
+        for (size_t slot = keyHash & mask;; slot = (slot + 1) & mask) {
+            const Slot position = index[slot];
+            if (position == EMPTY_SLOT<Slot>) return NO_SLOT;
+            if (position != DUMMY_SLOT<Slot> && entries[position].hash == keyHash &&
+                keysEqual(entries[position].key, key)) {
+                return slot;
+            }
+        }
+    });
+}
+
+/* Purpose: Reads the entry position an index slot holds.
+ * Parameters:
+ *    slot – slot returned by findSlot()
+ */
+size_t OrderedHashTable::positionAt(const size_t slot) const {
+    return withIndex([slot](const auto* index) { return static_cast<size_t>(index[slot]); });
+}
+
+/* Purpose: Drops removed entries and rebuilds the index.
+ * Parameters:
+ *    minEntries – live entries the new index must hold
+ * Behavior:
+ *    Compacts the entry array in place, keeping its order, then sizes the
+ *    index to the smallest power of two (at least INLINE_SLOTS) that is
+ *    under 2/3 full at minEntries, and refills it from the stored hashes.
+ *    Entries that moved to the heap stay there.
+ */
+void OrderedHashTable::rebuild(const size_t minEntries) {
+    Entry* entries = entryData();
+    size_t kept = 0;
+    for (size_t i = 0; i < m_entryCount; i++) {
+        if (entries[i].removed) continue;
+        if (kept != i) entries[kept] = std::move(entries[i]);
+        kept++;
+    }
+    if (m_entriesInline) {
+        std::fill(inlineEntries.begin() + static_cast<std::ptrdiff_t>(kept), inlineEntries.end(), Entry{});
+    } else {
+        heapEntries.resize(kept);
+    }
+    m_entryCount = kept;
+
+    size_t slots = INLINE_SLOTS;
+    while (slots * 2 < std::max(minEntries, kept) * 3) {
+        slots *= 2;
+    }
+    allocateIndex(slots);
+
+    const size_t mask = slots - 1;
+    withIndex([&](auto* index) {
+        using Slot = std::remove_pointer_t<decltype(index)>;
+        for (size_t position = 0; position < kept; position++) {
+            size_t slot = entries[position].hash & mask;
+            while (index[slot] != EMPTY_SLOT<Slot>) {
+                slot = (slot + 1) & mask;
+            }
+            index[slot] = static_cast<Slot>(position);
+        }
+    });
+}
+
+/* Purpose: Appends a key known to be missing.
+ * Returns:
+ *    size_t – position of the new entry
+ * Behavior:
+ *    First rebuilds the index, doubling it for the live entries, once the
+ *    entry array (removed entries included) would pass 2/3 of the slots.
+ *    The entry after the last inline one moves all entries to the heap.
+ *    The entry takes the first empty or removed slot of its run.
+ */
+size_t OrderedHashTable::append(const std::string_view key, const uint64_t keyHash, const int value) {
+    if ((m_entryCount + 1) * 3 > m_slots * 2) {
+        rebuild(2 * (m_size + 1));
+    }
+    if (m_entriesInline && m_entryCount == INLINE_ENTRIES) {
+        heapEntries.reserve(2 * INLINE_ENTRIES);
+        for (Entry& entry : inlineEntries) {
+            heapEntries.push_back(std::move(entry));
+            entry = Entry{};
+        }
+        m_entriesInline = false;
+    }
+
+    const size_t position = m_entryCount;
+    const size_t mask = m_slots - 1;
+    withIndex([&](auto* index) {
+        using Slot = std::remove_pointer_t<decltype(index)>;
+        size_t slot = keyHash & mask;
+        while (index[slot] != EMPTY_SLOT<Slot> && index[slot] != DUMMY_SLOT<Slot>) {
+            slot = (slot + 1) & mask;
+        }
+        index[slot] = static_cast<Slot>(position);
+    });
+
+    Entry entry{keyHash, std::string(key), value};
+    if (m_entriesInline) {
+        inlineEntries[position] = std::move(entry);
+    } else {
+        heapEntries.push_back(std::move(entry));
+    }
+    m_entryCount++;
+    m_size++;
+    return position;
+}
+
+/* Purpose: Inserts a key-value pair into the hash table.
+ * Parameters:
+ *    key – string key to insert
+ *    value – integer value to associate with key
+ * Returns:
+ *    true if insertion succeeded, false if key already exists
+ * Behavior:
+ *    A new key goes after every existing entry.
+ */
+bool OrderedHashTable::insert(const std::string& key, const int value) {
+    const uint64_t h = keyHash(key);
+    if (findSlot(key, h) != NO_SLOT) return false;
+    append(key, h, value);
+    return true;
+}
+
+/* Purpose: Inserts a key-value pair, or replaces the value of an existing key.
+ * Parameters:
+ *    key – string key to insert or update
+ *    value – value to store
+ * Returns:
+ *    true if the key was inserted, false if its value was replaced
+ * Behavior:
+ *    Replacing a value keeps the entry's place in the order.
+ */
+bool OrderedHashTable::insertOrAssign(const std::string& key, const int value) {
+    const uint64_t h = keyHash(key);
+    const size_t slot = findSlot(key, h);
+    if (slot == NO_SLOT) {
+        append(key, h, value);
+        return true;
+    }
+    entryData()[positionAt(slot)].value = value;
+    return false;
+}
+
+/* Purpose: Removes a key-value pair from the hash table.
+ * Parameters:
+ *    key – string key to remove
+ * Returns:
+ *    true if key was found and removed, false otherwise
+ * Behavior:
+ *    Marks the entry removed and frees its key; the entry and its index
+ *    slot are reclaimed by the next rebuild. Inserting the key again puts
+ *    it last.
+ */
+bool OrderedHashTable::remove(const std::string& key) {
+    const size_t slot = findSlot(key, keyHash(key));
+    if (slot == NO_SLOT) return false;
+
+    Entry& entry = entryData()[positionAt(slot)];
+    entry.removed = true;
+    std::string().swap(entry.key);
+    withIndex([slot](auto* index) { index[slot] = DUMMY_SLOT<std::remove_pointer_t<decltype(index)>>; });
+    m_size--;
+    return true;
+}
+
+/* Purpose: Checks whether the table contains a key.
+ * Parameters:
+ *    key – string key to search
+ * Returns:
+ *    true if key exists, false otherwise
+ */
+bool OrderedHashTable::contains(const std::string& key) const {
+    return findSlot(key, keyHash(key)) != NO_SLOT;
+}
+
+/* Purpose: Retrieves the value associated with a key.
+ * Parameters:
+ *    key – string key to lookup
+ * Returns:
+ *    optional<int> containing value if key exists, nullopt otherwise
+ */
+std::optional<int> OrderedHashTable::get(const std::string& key) const {
+    const size_t slot = findSlot(key, keyHash(key));
+    if (slot == NO_SLOT) return std::nullopt;
+    return entryData()[positionAt(slot)].value;
+}
+
+/* Purpose: Returns all keys currently in the hash table.
+ * Returns:
+ *    vector<string> containing all keys, in insertion order
+ */
+std::vector<std::string> OrderedHashTable::keys() const {
+    std::vector<std::string> keys;
+    keys.reserve(m_size);
+    forEach([&keys](const std::string_view key, int) { keys.emplace_back(key); });
+    return keys;
+}
+
+/* Purpose: Makes room for a number of entries without further resizes.
+ * Parameters:
+ *    entries – live entries the table should hold
+ * Behavior:
+ *    A count over INLINE_ENTRIES does not move the entries to the heap
+ *    yet; that happens when they no longer fit.
+ */
+void OrderedHashTable::reserve(const size_t entries) {
+    if (entries * 3 > m_slots * 2) rebuild(entries);
+    if (!m_entriesInline) heapEntries.reserve(entries);
+}
+
+/* Purpose: Returns current load factor of the index.
+ * Returns:
+ *    double – ratio of live entries to index slots
+ */
+double OrderedHashTable::alpha() const {
+    return static_cast<double>(m_size) / static_cast<double>(m_slots);
+}
+
+/* Purpose: Returns total number of index slots.
+ * Returns:
+ *    size_t – slot count, a power of two
+ */
+size_t OrderedHashTable::capacity() const {
+    return m_slots;
+}
+
+/* Purpose: Returns number of key-value pairs in the table.
+ * Returns:
+ *    size_t – number of live entries
+ */
+size_t OrderedHashTable::size() const {
+    return m_size;
+}
+
+/* Purpose: Returns the width of an index slot.
+ * Returns:
+ *    size_t – 1, 2 or 4 bytes
+ */
+size_t OrderedHashTable::indexWidth() const {
+    return withIndex([](const auto* index) { return sizeof(*index); });
+}
+
+/* Purpose: Checks whether the index and entries still live in the table object.
+ * Returns:
+ *    true if neither has been moved to the heap; keys too long for the
+ *    short-string buffer are still allocated
+ */
+bool OrderedHashTable::isInline() const {
+    return m_entriesInline && m_slots <= INLINE_SLOTS;
+}
+
+/* Purpose: Returns the memory the table occupies.
+ * Returns:
+ *    size_t – the table object plus its heap index, heap entry array and
+ *    the storage of keys too long for the short-string buffer
+ */
+size_t OrderedHashTable::bytes() const {
+    size_t total = sizeof(*this) + heapEntries.capacity() * sizeof(Entry);
+    total += std::visit([](const auto& slots) { return slots.capacity() * sizeof(slots[0]); }, heapIndex);
+
+    const size_t shortKeyLimit = std::string().capacity();
+    const Entry* entries = entryData();
+    for (size_t i = 0; i < m_entryCount; i++) {
+        if (entries[i].key.capacity() > shortKeyLimit) total += entries[i].key.capacity() + 1;
+    }
+    return total;
+}
+
+/* Purpose: Accesses value by key using bracket notation.
+ * Parameters:
+ *    key – string key to access
+ * Returns:
+ *    reference to the value associated with the key
+ * Behavior:
+ *    A missing key is appended with value 0, like HashTable::operator[].
+ *    The reference is valid until the next insertion.
+ */
+int& OrderedHashTable::operator[](const std::string& key) {
+    const uint64_t h = keyHash(key);
+    const size_t slot = findSlot(key, h);
+    const size_t position = slot == NO_SLOT ? append(key, h, 0) : positionAt(slot);
+    return entryData()[position].value;
+}
+
+/* Purpose: Prints the hash table to an output stream.
+ * Parameters:
+ *    os – output stream (e.g., cout)
+ * Behavior:
+ *    Prints all entries in insertion order.
+ */
+std::ostream& operator<<(std::ostream& os, const OrderedHashTable& table) {
+    os << table.printMe();
+    return os;
+}
+
+/* Purpose: Returns a string representation of the hash table.
+ * Returns:
+ *    string – one line per entry, oldest first, numbered from 0
+ */
+std::string OrderedHashTable::printMe() const {
+    std::ostringstream out;
+    size_t n = 0;
+
+    forEach([&](const std::string_view key, const int value) {
+        out << "Entry " << n++ << ": <" << key << ", " << value << ">\n";
+    });
+
+    return out.str();
+}
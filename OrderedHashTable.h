@@ -0,0 +1,115 @@
+/*
+ * OrderedHashTable.h
+ */
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+class OrderedHashTable {
+    private:
+        static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+        static constexpr size_t INLINE_ENTRIES = 8; // entries kept in the table object itself
+        static constexpr size_t INLINE_SLOTS = 16; // one-byte index slots kept in the table object itself
+
+        // one key-value pair; entries stay in insertion order
+        struct Entry {
+            uint64_t hash = 0; // keyHash() of key, so rebuilding the index never reads a key
+            std::string key;
+            int value = 0;
+            bool removed = false; // kept in place until the next rebuild, so later positions stay valid
+        };
+
+        // index slots hold an entry position, or the two largest values of their width for empty and removed
+        using HeapIndex = std::variant<std::vector<uint8_t>, std::vector<uint16_t>, std::vector<uint32_t>>;
+
+        std::array<uint8_t, INLINE_SLOTS> inlineIndex{}; // the index while it has INLINE_SLOTS slots
+        HeapIndex heapIndex; // the index once it is larger, in the narrowest width that fits its positions
+        std::array<Entry, INLINE_ENTRIES> inlineEntries; // the entries until there are more than INLINE_ENTRIES
+        std::vector<Entry> heapEntries; // the entries from then on
+        size_t m_slots; // index slots, a power of two
+        size_t m_entryCount = 0; // entries in use, removed ones included
+        size_t m_size = 0; // live entries
+        bool m_entriesInline = true;
+
+        template <typename Fn>
+        decltype(auto) withIndex(Fn&& fn);
+
+        template <typename Fn>
+        decltype(auto) withIndex(Fn&& fn) const;
+
+        [[nodiscard]] Entry* entryData();
+
+        [[nodiscard]] const Entry* entryData() const;
+
+        void allocateIndex(size_t slots);
+
+        void resetInline() noexcept;
+
+        [[nodiscard]] size_t findSlot(std::string_view key, uint64_t keyHash) const;
+
+        [[nodiscard]] size_t positionAt(size_t slot) const;
+
+        void rebuild(size_t minEntries);
+
+        size_t append(std::string_view key, uint64_t keyHash, int value);
+
+    public:
+        static constexpr size_t DEFAULT_INITIAL_CAPACITY = INLINE_SLOTS;
+
+        OrderedHashTable(size_t initCapacity = DEFAULT_INITIAL_CAPACITY); // default constructor
+
+        OrderedHashTable(const OrderedHashTable&) = default;
+        OrderedHashTable& operator=(const OrderedHashTable&) = default;
+        OrderedHashTable(OrderedHashTable&& other) noexcept;
+        OrderedHashTable& operator=(OrderedHashTable&& other) noexcept;
+
+        bool insert(const std::string& key, int value);
+
+        bool insertOrAssign(const std::string& key, int value);
+
+        bool remove(const std::string& key);
+
+        [[nodiscard]] bool contains(const std::string& key) const;
+
+        [[nodiscard]] std::optional<int> get(const std::string& key) const;
+
+        [[nodiscard]] std::vector<std::string> keys() const;
+
+        /* Purpose: Calls fn(key, value) for every entry, oldest first.
+         * Behavior:
+         *    Reads the dense entry array front to back, so there are no
+         *    empty slots to skip; key is a string_view into the entry.
+         */
+        template <typename Fn>
+        void forEach(Fn&& fn) const {
+            const Entry* entries = entryData();
+            for (size_t i = 0; i < m_entryCount; i++) {
+                if (!entries[i].removed) fn(std::string_view(entries[i].key), entries[i].value);
+            }
+        }
+
+        void reserve(size_t entries);
+
+        [[nodiscard]] double alpha() const;
+
+        [[nodiscard]] size_t capacity() const;
+
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] size_t indexWidth() const;
+
+        [[nodiscard]] bool isInline() const;
+
+        [[nodiscard]] size_t bytes() const;
+
+        int& operator[](const std::string& key);
+
+        friend std::ostream& operator<<(std::ostream& os, const OrderedHashTable& hashTable);
+
+        [[nodiscard]] std::string printMe() const;
+};
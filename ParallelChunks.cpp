@@ -0,0 +1,122 @@
+/* Filename: ParallelChunks.cpp
+ * Project: Project 4 - Hash Table
+ * Program Description: This file implements a small work-stealing scheduler for
+ * scans over a table split into equal chunks. Each worker starts with a
+ * contiguous share of the chunks and takes them from the front. A worker that
+ * runs out steals the back half of another worker's remaining share, so
+ * unevenly filled chunks still finish together.
+ */
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ParallelChunks.h"
+
+namespace {
+
+// one worker's remaining chunks, padded to a cache line so owners do not contend
+struct alignas(64) ChunkRange {
+    std::mutex lock;
+    size_t next = 0; // owner takes from here
+    size_t end = 0; // thieves take from here down
+};
+
+/* Purpose: Takes the owner's next chunk.
+ * Returns:
+ *    true and sets chunk if the range was not empty
+ */
+bool takeFront(ChunkRange& range, size_t& chunk) {
+    std::lock_guard<std::mutex> guard(range.lock);
+    if (range.next == range.end) return false;
+    chunk = range.next++;
+    return true;
+}
+
+/* Purpose: Moves the back half of a victim's chunks into an empty range.
+ * Returns:
+ *    true if anything was stolen
+ */
+bool stealHalf(ChunkRange& victim, ChunkRange& thief) {
+    size_t begin;
+    size_t end;
+    {
+        std::lock_guard<std::mutex> guard(victim.lock);
+        const size_t remaining = victim.end - victim.next;
+        if (remaining == 0) return false;
+        end = victim.end;
+        begin = end - (remaining + 1) / 2;
+        victim.end = begin;
+    }
+    std::lock_guard<std::mutex> guard(thief.lock);
+    thief.next = begin;
+    thief.end = end;
+    return true;
+}
+
+} // namespace
+
+/* Purpose: Turns a requested thread count into an actual one.
+ * Parameters:
+ *    threads – requested count (0 = hardware concurrency)
+ * Returns:
+ *    size_t – at least 1
+ */
+size_t resolveThreads(const size_t threads) {
+    return threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+/* Purpose: Runs fn once for every chunk in [0, chunkCount).
+ * Parameters:
+ *    chunkCount – number of chunks
+ *    threads – worker threads (0 = hardware concurrency); the calling thread
+ *              is worker 0
+ *    fn – called as fn(chunk, worker) with worker in [0, threads)
+ * Behavior:
+ *    Chunks are dealt out in contiguous shares and rebalanced by stealing.
+ *    A worker exits once every share is empty. With one thread, or no more
+ *    chunks than that, everything runs on the calling thread in chunk
+ *    order. If fn throws, the first exception is rethrown on the calling
+ *    thread after all workers have stopped.
+ */
+void parallelChunks(const size_t chunkCount, size_t threads, const std::function<void(size_t chunk, size_t worker)>& fn) {
+    threads = std::min(resolveThreads(threads), std::max<size_t>(chunkCount, 1));
+    if (threads == 1) {
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) fn(chunk, 0);
+        return;
+    }
+
+    std::vector<ChunkRange> ranges(threads);
+    for (size_t t = 0; t < threads; t++) {
+        ranges[t].next = chunkCount * t / threads;
+        ranges[t].end = chunkCount * (t + 1) / threads;
+    }
+
+    std::mutex errorLock;
+    std::exception_ptr error;
+
+    const auto work = [&](const size_t worker) {
+        try {
+            size_t chunk;
+            for (;;) {
+                while (takeFront(ranges[worker], chunk)) fn(chunk, worker);
+
+                bool stole = false;
+                for (size_t step = 1; step < threads && !stole; step++) {
+                    stole = stealHalf(ranges[(worker + step) % threads], ranges[worker]);
+                }
+                if (!stole) return; // shares only shrink, so all work is taken
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(errorLock);
+            if (!error) error = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++) workers.emplace_back(work, t);
+    work(0);
+    for (std::thread& worker : workers) worker.join();
+    if (error) std::rethrow_exception(error);
+}
@@ -0,0 +1,10 @@
+/*
+ * ParallelChunks.h
+ */
+#pragma once
+#include <cstddef>
+#include <functional>
+
+[[nodiscard]] size_t resolveThreads(size_t threads);
+
+void parallelChunks(size_t chunkCount, size_t threads, const std::function<void(size_t chunk, size_t worker)>& fn);